@@ -0,0 +1,37 @@
+#ifndef AUTOTUNE_HPP
+#define AUTOTUNE_HPP
+
+#include <vector>
+#include <string>
+#include "layers.hpp"
+#include "neural_network.hpp"
+
+// Machine-specific training/evaluation settings written by the autotuner
+struct TuningProfile {
+    int batch_size = 32;
+    int num_threads = 0;                    // 0 = OpenMP default (OMP_NUM_THREADS or all cores)
+    DenseTiling tiling;
+    std::string lr_scaling = "sqrt";        // Learning-rate rule for batch size: "none", "linear" or "sqrt"
+    int base_batch_size = 32;               // Batch size the base learning rate was chosen for
+
+    // Learning rate for batch_size, scaled from base_lr according to lr_scaling
+    float scaled_learning_rate(float base_lr) const;
+
+    // Set the OpenMP thread count and DenseLayer tiling
+    void apply() const;
+};
+
+// Save and load a tuning profile (plain "key value" lines)
+void save_tuning_profile(const std::string& path, const TuningProfile& profile);
+bool load_tuning_profile(const std::string& path, TuningProfile& profile);
+
+// Run short timed training trials on `model` and return the fastest settings found.
+// Tiling, thread count and batch size are tuned in turn, then tiling is re-tuned for the chosen batch size.
+// Weights are not modified (trials use a zero learning rate).
+TuningProfile autotune(NeuralNetwork& model,
+                       const std::vector<std::vector<float>>& images,
+                       const std::vector<std::vector<float>>& one_hot_labels,
+                       const TuningProfile& initial,
+                       double seconds_per_trial = 0.5);
+
+#endif // AUTOTUNE_HPP
@@ -0,0 +1,62 @@
+#ifndef CASCADE_HPP
+#define CASCADE_HPP
+
+#include <vector>
+#include <string>
+#include "neural_network.hpp"
+
+// How confident a softmax output is
+enum class ConfidenceMeasure {
+    TopProbability,                         // Largest class probability
+    Margin                                  // Largest minus second-largest probability
+};
+
+float confidence(const std::vector<float>& probabilities, ConfidenceMeasure measure);
+
+// Two-stage classifier: every sample goes through the small model, and only samples whose
+// confidence is below the threshold are forwarded, as one batch, to the large model.
+class CascadeClassifier {
+private:
+    NeuralNetwork& small_model;
+    NeuralNetwork& large_model;
+    float threshold;
+    ConfidenceMeasure measure;
+
+public:
+    CascadeClassifier(NeuralNetwork& small_model, NeuralNetwork& large_model,
+                      float threshold, ConfidenceMeasure measure = ConfidenceMeasure::TopProbability);
+
+    // Class probabilities for each input; escalated (if given) receives the number of samples sent to the large model
+    std::vector<std::vector<float>> forward(const std::vector<std::vector<float>>& inputs, size_t* escalated = nullptr);
+};
+
+struct CascadeSettings {
+    float threshold = 0.9f;
+    ConfidenceMeasure measure = ConfidenceMeasure::TopProbability;
+};
+
+struct CascadeReport {
+    float accuracy = 0.0f;                  // Percent
+    float escalated_fraction = 0.0f;
+    double latency_ms = 0.0;                // Average per batch
+    double large_latency_ms = 0.0;          // Average per batch with the large model alone
+};
+
+// Save and load cascade settings (plain "key value" lines)
+void save_cascade_settings(const std::string& path, const CascadeSettings& settings);
+bool load_cascade_settings(const std::string& path, CascadeSettings& settings);
+
+// Lowest threshold whose cascade accuracy on (images, labels) reaches target_accuracy (percent).
+// If the target is above what escalating everything achieves, every sample is escalated.
+float calibrate_cascade_threshold(NeuralNetwork& small_model, NeuralNetwork& large_model,
+                                  const std::vector<std::vector<float>>& images,
+                                  const std::vector<std::vector<float>>& one_hot_labels,
+                                  float target_accuracy, ConfidenceMeasure measure);
+
+// Run the cascade and the large model alone over (images, labels) in batches and compare them
+CascadeReport measure_cascade(CascadeClassifier& cascade, NeuralNetwork& large_model,
+                              const std::vector<std::vector<float>>& images,
+                              const std::vector<std::vector<float>>& one_hot_labels,
+                              int batch_size);
+
+#endif // CASCADE_HPP
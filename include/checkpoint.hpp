@@ -0,0 +1,60 @@
+#ifndef CHECKPOINT_HPP
+#define CHECKPOINT_HPP
+
+#include <vector>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "neural_network.hpp"
+#include "optimizer.hpp"
+
+// Position of the training loop, saved alongside the model so a run can resume mid-epoch
+struct TrainingState {
+    int epoch = 0;                  // Epoch in progress
+    size_t next_batch = 0;          // First batch of that epoch not yet trained on
+    int batch_size = 0;             // Batch size next_batch counts in
+    float epoch_loss = 0.0f;        // Partial epoch metrics up to next_batch
+    int correct = 0;
+    std::string rng_state;          // Serialized std::mt19937 used for shuffling
+    std::vector<size_t> order;      // Sample order of the current epoch
+};
+
+// Writes checkpoints on a background thread. submit() only copies the model into an
+// in-memory buffer; the file is written to "<path>.tmp" and atomically renamed over <path>.
+class CheckpointWriter {
+private:
+    std::string path;
+    std::vector<char> staging;      // Snapshot being filled by the training thread, or queued for the writer
+    std::vector<char> writing;      // Snapshot owned by the writer thread
+    bool queued = false;            // staging holds a snapshot the writer has not picked up yet
+    bool busy = false;              // The writer is writing a snapshot
+    bool stopping = false;
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::thread writer;
+
+    void run();
+
+public:
+    explicit CheckpointWriter(const std::string& path);
+    ~CheckpointWriter();
+
+    // Snapshot the training state and queue it for writing. If the writer is still busy, the snapshot
+    // waits for it (replacing any older queued one), so the training loop never waits on disk I/O.
+    void submit(const NeuralNetwork& model, const Optimizer& optimizer, const TrainingState& state);
+
+    // Block until the last submitted checkpoint is on disk
+    void wait();
+};
+
+// Save a model file the way checkpoints are written: to "<path>.tmp", flushed to disk, then atomically
+// renamed over <path>, so readers (such as a hot-reloading server) never see a partial file
+void save_model_atomic(const std::string& path, const NeuralNetwork& model);
+
+// Restore a checkpoint written by CheckpointWriter for a training set of num_samples samples.
+// Returns false if the file does not exist; throws if it is corrupt or was written for a different training set.
+bool load_checkpoint(const std::string& path, NeuralNetwork& model, Optimizer& optimizer, TrainingState& state,
+                     size_t num_samples);
+
+#endif // CHECKPOINT_HPP
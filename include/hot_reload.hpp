@@ -0,0 +1,71 @@
+#ifndef HOT_RELOAD_HPP
+#define HOT_RELOAD_HPP
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <functional>
+#include "neural_network.hpp"
+
+// One loaded set of weights. Forward passes on a version are serialized because layers cache their inputs.
+struct ModelVersion {
+    NeuralNetwork model;
+    std::mutex mutex;
+    int id = 0;
+    float canary_accuracy = 0.0f;           // Percent
+};
+
+struct ReloadStats {
+    int reloads = 0;                        // New versions swapped in
+    int rejected = 0;                       // Changes that failed to load or validate
+    double max_load_ms = 0.0;               // Longest load + canary validation, off the request path
+    double max_swap_us = 0.0;               // Longest pointer swap
+};
+
+// Serves a model file and keeps it current. A watcher thread polls the file; when it changes (and has stopped
+// changing for one poll interval) the new weights are loaded into a separate instance, scored on a canary set
+// and, if accurate enough, published with an atomic pointer swap. Each forward call pins the version it started
+// on, so in-flight batches finish on the old weights; retired versions are freed by the watcher once unused.
+class HotReloadModel {
+public:
+    typedef std::function<void(NeuralNetwork&)> ModelFactory;   // Builds the layers weights are loaded into
+
+private:
+    std::string path;
+    ModelFactory factory;
+    const std::vector<std::vector<float>>& canary_images;
+    const std::vector<std::vector<float>>& one_hot_canary_labels;
+    float min_canary_accuracy;
+    int poll_ms;
+
+    std::shared_ptr<ModelVersion> current;  // Only accessed through std::atomic_load / std::atomic_store
+    std::vector<std::shared_ptr<ModelVersion>> retired;
+    ReloadStats reload_stats;
+    mutable std::mutex stats_mutex;
+
+    bool stopping = false;
+    std::mutex stop_mutex;
+    std::condition_variable stop_cv;
+    std::thread watcher;
+
+    std::shared_ptr<ModelVersion> load_version(int id) const;
+    void watch();
+
+public:
+    // Loads and validates the initial version; throws if it fails
+    HotReloadModel(const std::string& path, const ModelFactory& factory,
+                   const std::vector<std::vector<float>>& canary_images,
+                   const std::vector<std::vector<float>>& one_hot_canary_labels,
+                   float min_canary_accuracy, int poll_ms = 200);
+    ~HotReloadModel();
+
+    // Class probabilities from the current version
+    std::vector<std::vector<float>> forward(const std::vector<std::vector<float>>& inputs);
+
+    ReloadStats stats() const;
+};
+
+#endif // HOT_RELOAD_HPP
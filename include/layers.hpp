@@ -4,6 +4,7 @@
 #include <vector>
 #include <string>
 #include <iostream>
+#include <cstdint>
 #include "optimizer.hpp"
 
 class Layer {
@@ -24,13 +25,28 @@ public:
     virtual void load(std::istream& is) = 0;
 };
 
+// Loop tiling of the unpacked DenseLayer kernels (training and unpacked forward), chosen per machine by the autotuner.
+// Packed inference uses a fixed tile of PANEL_WIDTH outputs by 4 samples instead.
+struct DenseTiling {
+    size_t batch_tile = 4;                      // Samples per tile
+    size_t input_tile = 128;                    // Weight rows (inputs) per tile
+    size_t output_tile = 256;                   // Weight columns (outputs) per tile
+};
+
 class DenseLayer : public Layer {
+public:
+    static const size_t PANEL_WIDTH = 16;       // Outputs per packed weight panel
+
 private:
-    std::vector<std::vector<float>> weights;     // Weight matrix
+    static DenseTiling tiling;                  // Shared by all DenseLayers
+
+    std::vector<std::vector<float>> weights;     // Weight matrix (canonical layout, used for training and serialization)
     std::vector<float> biases;                   // Bias vector
+    std::vector<float> packed_weights;           // Inference layout from pack() (empty when stale)
     std::vector<std::vector<float>> inputs;      // Cached inputs for backpropagation
     std::vector<std::vector<float>> weight_gradients;
     std::vector<float> bias_gradients;
+    std::vector<std::vector<unsigned char>> weight_mask; // Pruning mask (empty when the layer is dense)
 
 public:
     DenseLayer(int input_size, int output_size);
@@ -41,14 +57,73 @@ public:
 
     void save(std::ostream& os) const override;
     void load(std::istream& is) override;
+
+    // Magnitude pruning: zero the weight blocks with the smallest L1 norm until
+    // target_sparsity of the blocks are removed. Pruned weights stay zero in later updates.
+    void prune(float target_sparsity);
+
+    // Fraction of weights that are exactly zero
+    float sparsity() const;
+
+    // Copy the weights into panels of PANEL_WIDTH outputs, each stored contiguously along the inputs
+    // and zero-padded, so the forward pass streams every panel once with no strided access.
+    // Call after loading a model for inference; updating or pruning the weights frees the packed copy.
+    void pack();
+
+    // Kernel tiling used by every DenseLayer
+    static void set_tiling(const DenseTiling& config);
+
+    const std::vector<std::vector<float>>& get_weights() const { return weights; }
+    const std::vector<float>& get_biases() const { return biases; }
 };
 
+// Inference-only dense layer with block-sparse (BSR, 1 x BLOCK_SIZE) weights.
+// Each input row k stores only its non-zero blocks of BLOCK_SIZE consecutive outputs,
+// so the forward pass is a sequence of fixed-width AXPYs that the compiler vectorizes.
+class SparseDenseLayer : public Layer {
+public:
+    static const size_t BLOCK_SIZE = 8;         // Outputs per block (one AVX register of floats)
+
+private:
+    size_t input_size;
+    size_t output_size;
+    std::vector<uint32_t> row_ptr;              // Block range of input row k: [row_ptr[k], row_ptr[k + 1])
+    std::vector<uint32_t> block_cols;           // First output column of each block
+    std::vector<float> values;                  // BLOCK_SIZE weights per block
+    std::vector<float> biases;
+
+public:
+    SparseDenseLayer(int input_size, int output_size);   // Empty layer of this shape, to load() into
+    explicit SparseDenseLayer(const DenseLayer& dense);
+
+    std::vector<std::vector<float>> forward(const std::vector<std::vector<float>>& inputs) override;
+    std::vector<std::vector<float>> backward(const std::vector<std::vector<float>>& gradient) override;
+    void update(Optimizer& optimizer) override {}
+
+    void save(std::ostream& os) const override;
+    void load(std::istream& is) override;
+};
+
+// Supported activation functions
+enum class Activation {
+    ReLU,
+    LeakyReLU,
+    Sigmoid,
+    Tanh,
+    GELU,
+    Softmax
+};
+
+// Parse an activation name: "relu", "leaky_relu", "sigmoid", "tanh", "gelu" or "softmax"
+Activation parse_activation(const std::string& name);
+
 class ActivationLayer : public Layer {
 private:
-    std::string activation_type;                // Activation type (e.g., "relu", "softmax")
+    Activation activation;                      // Selects the forward/backward kernels
     std::vector<std::vector<float>> inputs;     // Cached inputs for backpropagation
 
 public:
+    explicit ActivationLayer(Activation type);
     explicit ActivationLayer(const std::string& type);
 
     std::vector<std::vector<float>> forward(const std::vector<std::vector<float>>& inputs) override;
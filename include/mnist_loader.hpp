@@ -3,6 +3,8 @@
 
 #include <vector>
 #include <string>
+#include <iostream>
+#include <cstdint>
 
 // Load MNIST images
 std::vector<std::vector<float>> load_mnist_images(const std::string& path);
@@ -16,4 +18,28 @@ void normalize_images(std::vector<std::vector<float>>& images);
 // One-hot encode labels
 std::vector<std::vector<float>> one_hot_encode(const std::vector<int>& labels, int num_classes);
 
+// Incremental reader for a labeled record stream (stdin, a pipe or a FIFO). The stream starts with
+// an IDX3 image header (magic 2051, image count or 0 if unbounded, rows, cols) followed by one
+// record per image: the label byte, then rows * cols pixel bytes.
+class MnistStreamReader {
+private:
+    std::istream& input;
+    size_t pixels_per_image = 0;
+    uint32_t remaining = 0;         // Records left in a bounded stream
+    bool bounded = false;
+
+public:
+    // Reads the header; throws if it is not an IDX3 image header
+    explicit MnistStreamReader(std::istream& input);
+
+    size_t image_size() const { return pixels_per_image; }
+
+    // Read the next record into image (raw pixels) and label. Returns false at the end of the stream.
+    bool next(std::vector<unsigned char>& image, int& label);
+};
+
+// Write raw (unnormalized) images and their labels as a labeled record stream; count 0 marks it unbounded
+void write_mnist_stream_header(std::ostream& output, uint32_t count, uint32_t rows, uint32_t cols);
+void write_mnist_record(std::ostream& output, const std::vector<float>& image, int label);
+
 #endif // MNIST_LOADER_HPP
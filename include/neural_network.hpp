@@ -3,6 +3,7 @@
 
 #include <vector>
 #include <string>
+#include <iostream>
 #include "layers.hpp"
 #include "optimizer.hpp"
 
@@ -27,9 +28,25 @@ public:
     // Update weights
     void update(Optimizer& optimizer);
 
+    // Magnitude-prune each DenseLayer to its own target sparsity (one entry per DenseLayer, in order)
+    void prune(const std::vector<float>& target_sparsities);
+
+    // Sparsity of each DenseLayer, in order
+    std::vector<float> sparsities() const;
+
+    // Replace every DenseLayer with an inference-only SparseDenseLayer
+    void sparsify();
+
+    // Pack every DenseLayer's weights into the inference layout; models loaded for training stay unpacked
+    void pack();
+
     // Save and load model
     void save(const std::string& filepath) const;
     void load(const std::string& filepath);
+
+    // Save and load layer parameters to/from a stream (used for in-memory snapshots)
+    void save(std::ostream& os) const;
+    void load(std::istream& is);
 };
 
 #endif // NEURAL_NETWORK_HPP
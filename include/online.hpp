@@ -0,0 +1,57 @@
+#ifndef ONLINE_HPP
+#define ONLINE_HPP
+
+#include <vector>
+#include <random>
+#include <functional>
+#include "mnist_loader.hpp"
+#include "neural_network.hpp"
+#include "optimizer.hpp"
+
+// Fixed-capacity store of raw records. Once full, each new record overwrites the oldest,
+// so memory stays at capacity * (image_size + 1) bytes however much data is streamed.
+class ReplayBuffer {
+private:
+    std::vector<unsigned char> images;  // capacity * image_size raw pixels
+    std::vector<unsigned char> labels;
+    size_t image_size;
+    size_t capacity;
+    size_t count = 0;
+    size_t next = 0;                    // Slot the next record is written to
+
+public:
+    ReplayBuffer(size_t capacity, size_t image_size);
+
+    void add(const std::vector<unsigned char>& image, int label);
+    size_t size() const { return count; }
+
+    // Overwrite inputs (normalized to [0, 1]) and one-hot labels with batch_size records drawn uniformly at random
+    void sample(size_t batch_size, int num_classes, std::mt19937& rng,
+                std::vector<std::vector<float>>& inputs, std::vector<std::vector<float>>& one_hot_labels) const;
+};
+
+struct OnlineOptions {
+    size_t buffer_size = 10000;         // Replay buffer capacity (records)
+    int batch_size = 32;
+    size_t update_every = 32;           // New records between minibatch updates
+    size_t eval_every = 10000;          // New records between held-out evaluations (0 = only at the end)
+};
+
+struct OnlineStats {
+    size_t records = 0;                 // Records read from the stream
+    size_t updates = 0;                 // Minibatch updates applied
+    float holdout_accuracy = 0.0f;      // Percent, at the last evaluation
+};
+
+// Called after each held-out evaluation, e.g. to save the model
+typedef std::function<void(const OnlineStats&)> EvaluationCallback;
+
+// Train from the stream until it ends. Each record goes into the replay buffer; every update_every
+// records one minibatch is sampled from the buffer and trained on, and every eval_every records the
+// model is scored on the held-out set. Memory does not grow with the length of the stream.
+OnlineStats train_online(NeuralNetwork& model, Optimizer& optimizer, MnistStreamReader& stream,
+                         const std::vector<std::vector<float>>& holdout_images,
+                         const std::vector<std::vector<float>>& one_hot_holdout_labels,
+                         const OnlineOptions& options, const EvaluationCallback& on_evaluation = EvaluationCallback());
+
+#endif // ONLINE_HPP
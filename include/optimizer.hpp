@@ -2,6 +2,7 @@
 #define OPTIMIZER_HPP
 
 #include <vector>
+#include <iostream>
 
 class Optimizer {
 public:
@@ -9,6 +10,10 @@ public:
 
     virtual void update(std::vector<std::vector<float>>& weights, const std::vector<std::vector<float>>& gradients) = 0;
     virtual void update(std::vector<float>& biases, const std::vector<float>& gradients) = 0;
+
+    // Save and load optimizer state (for resumable checkpoints)
+    virtual void save(std::ostream& os) const = 0;
+    virtual void load(std::istream& is) = 0;
 };
 
 class SGDOptimizer : public Optimizer {
@@ -18,8 +23,13 @@ private:
 public:
     explicit SGDOptimizer(float lr) : learning_rate(lr) {}
 
+    float get_learning_rate() const { return learning_rate; }
+
     void update(std::vector<std::vector<float>>& weights, const std::vector<std::vector<float>>& gradients) override;
     void update(std::vector<float>& biases, const std::vector<float>& gradients) override;
+
+    void save(std::ostream& os) const override;
+    void load(std::istream& is) override;
 };
 
 #endif // OPTIMIZER_HPP
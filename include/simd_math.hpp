@@ -0,0 +1,142 @@
+#ifndef SIMD_MATH_HPP
+#define SIMD_MATH_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// Vectorizable float approximations of exp, log, tanh and erf.
+// The element-wise versions are inline and branch-free (selects only), so loops that call them
+// under `#pragma omp simd` compile to packed SIMD code. Error bounds are over the full float range,
+// measured against the double-precision <cmath> functions.
+namespace SimdMath {
+
+inline float bits_to_float(int32_t bits) {
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+inline int32_t float_to_bits(float value) {
+    int32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+// Branch-free select. Plain ?: on floats can be turned back into branches (float ops may trap),
+// which stops the loop from vectorizing; a bitwise blend cannot.
+inline float select(bool condition, float if_true, float if_false) {
+    int32_t mask = -static_cast<int32_t>(condition);
+    return bits_to_float((float_to_bits(if_true) & mask) | (float_to_bits(if_false) & ~mask));
+}
+
+// e^x, relative error < 2e-7. Inputs are clamped to [-87, 88], so the result is always finite and normal.
+inline float exp(float x) {
+    x = select(x < -87.0f, -87.0f, x);
+    x = select(x > 88.0f, 88.0f, x);
+
+    // x = n ln2 + r, |r| <= ln2 / 2, with ln2 split into high and low parts
+    float t = x * 1.44269504088896341f;
+    int32_t n = static_cast<int32_t>(t + select(t >= 0.0f, 0.5f, -0.5f));
+    float fn = static_cast<float>(n);
+    float r = x - fn * 0.693359375f + fn * 2.12194440e-4f;
+
+    float p = 1.9875691500e-4f;
+    p = p * r + 1.3981999507e-3f;
+    p = p * r + 8.3334519073e-3f;
+    p = p * r + 4.1665795894e-2f;
+    p = p * r + 1.6666665459e-1f;
+    p = p * r + 5.0000001201e-1f;
+    p = p * r * r + r + 1.0f;
+
+    return p * bits_to_float((n + 127) << 23);
+}
+
+// Natural log, absolute error < 2e-7 for x in [0.5, 2], relative error < 2e-7 elsewhere.
+// Non-positive and subnormal inputs are clamped to the smallest normal float; NaN and +inf are returned unchanged.
+inline float log(float x) {
+    const float input = x;
+    x = select(x < 1.17549435e-38f, 1.17549435e-38f, x);
+
+    // x = m 2^e with m in [sqrt(1/2), sqrt(2))
+    int32_t bits = float_to_bits(x);
+    int32_t e = ((bits >> 23) & 0xff) - 126;
+    float m = bits_to_float((bits & 0x007fffff) | 0x3f000000);
+    bool small = m < 0.707106781186547524f;
+    e -= small ? 1 : 0;
+    m = select(small, m + m, m) - 1.0f;
+    float fe = static_cast<float>(e);
+
+    float z = m * m;
+    float p = 7.0376836292e-2f;
+    p = p * m - 1.1514610310e-1f;
+    p = p * m + 1.1676998740e-1f;
+    p = p * m - 1.2420140846e-1f;
+    p = p * m + 1.4249322787e-1f;
+    p = p * m - 1.6668057665e-1f;
+    p = p * m + 2.0000714765e-1f;
+    p = p * m - 2.4999993993e-1f;
+    p = p * m + 3.3333331174e-1f;
+    p = p * m * z;
+
+    p += -2.12194440e-4f * fe;
+    p += -0.5f * z;
+    float result = m + p + 0.693359375f * fe;
+    return select(!(input <= 3.40282347e+38f), input, result);
+}
+
+// Hyperbolic tangent, absolute error < 2e-7.
+inline float tanh(float x) {
+    float ax = select(x < 0.0f, -x, x);
+
+    // Small inputs: odd polynomial; large inputs: 1 - 2 / (e^2|x| + 1)
+    float z = x * x;
+    float p = -5.70498872745e-3f;
+    p = p * z + 2.06390887954e-2f;
+    p = p * z - 5.37397155531e-2f;
+    p = p * z + 1.33314422036e-1f;
+    p = p * z - 3.33332819422e-1f;
+    float small = p * z * x + x;
+
+    float large = 1.0f - 2.0f / (exp(2.0f * ax) + 1.0f);
+    large = select(x < 0.0f, -large, large);
+
+    return select(ax < 0.625f, small, large);
+}
+
+// Error function, absolute error < 4e-7. |x| < 0.5 uses the Maclaurin series, larger inputs
+// Abramowitz & Stegun 7.1.26 (its 1 - (...) form loses precision to cancellation near zero).
+inline float erf(float x) {
+    float ax = select(x < 0.0f, -x, x);
+
+    float z = x * x;
+    float small = 1.2055333e-4f;            // 2/sqrt(pi) (-1)^n / (n! (2n + 1)), n = 6..0
+    small = small * z - 8.5483270e-4f;
+    small = small * z + 5.2239776e-3f;
+    small = small * z - 2.6866171e-2f;
+    small = small * z + 1.1283792e-1f;
+    small = small * z - 3.7612639e-1f;
+    small = small * z + 1.1283792f;
+    small *= x;
+
+    float t = 1.0f / (1.0f + 0.3275911f * ax);
+    float p = 1.061405429f;
+    p = p * t - 1.453152027f;
+    p = p * t + 1.421413741f;
+    p = p * t - 0.284496736f;
+    p = p * t + 0.254829592f;
+    float large = 1.0f - p * t * exp(-ax * ax);
+    large = select(x < 0.0f, -large, large);
+
+    return select(ax < 0.5f, small, large);
+}
+
+// Array version: y[i] = tanh(x[i]). x and y may alias.
+void tanh(const float* x, float* y, size_t n);
+
+// Numerically stable softmax of one row (max-subtracted). x and y may alias.
+void softmax(const float* x, float* y, size_t n);
+
+} // namespace SimdMath
+
+#endif // SIMD_MATH_HPP
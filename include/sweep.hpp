@@ -0,0 +1,51 @@
+#ifndef SWEEP_HPP
+#define SWEEP_HPP
+
+#include <vector>
+#include <string>
+
+// One model/optimizer variant of a hyperparameter sweep
+struct SweepRun {
+    std::string name;
+    std::vector<int> hidden_layers = {1024};    // Hidden DenseLayer widths
+    std::string activation = "relu";            // Hidden activation
+    float learning_rate = 0.1f;
+    int batch_size = 32;
+    int epochs = 5;
+};
+
+struct SweepConfig {
+    std::vector<SweepRun> runs;
+    int parallel = 0;                           // Runs trained at once (0 = one per OpenMP thread, up to the number of runs)
+    float keep_fraction = 0.5f;                 // At each epoch, runs outside the top keep_fraction are stopped
+    int grace_epochs = 1;                       // Epochs every run trains before it can be stopped
+    size_t validation_size = 5000;              // Training samples held out to rank runs
+};
+
+struct SweepResult {
+    std::string name;
+    int epochs_trained = 0;
+    bool stopped_early = false;
+    float validation_accuracy = 0.0f;           // Percent, after the last trained epoch
+    float test_accuracy = 0.0f;                 // Percent, on the test set
+    double seconds = 0.0;                       // Wall time spent training this run
+    size_t parameter_bytes = 0;
+};
+
+// Parse a sweep config. Each line is either a global setting ("parallel 4", "keep_fraction 0.5",
+// "grace_epochs 1", "validation_size 5000") or a run:
+//   run name=wide layers=1024,1024 activation=relu lr=0.1 batch=32 epochs=5
+// Blank lines and lines starting with '#' are ignored.
+SweepConfig load_sweep_config(const std::string& path);
+
+// Train every run of the sweep concurrently on one shared copy of the dataset.
+// OpenMP threads are split evenly between the runs in flight; the scheduler always advances the run with the
+// fewest trained epochs, and after each epoch stops runs that rank outside the top keep_fraction
+// of the runs that have reached the same epoch.
+std::vector<SweepResult> run_sweep(const SweepConfig& config,
+                                   const std::vector<std::vector<float>>& train_images,
+                                   const std::vector<std::vector<float>>& one_hot_train_labels,
+                                   const std::vector<std::vector<float>>& test_images,
+                                   const std::vector<std::vector<float>>& one_hot_test_labels);
+
+#endif // SWEEP_HPP
@@ -0,0 +1,30 @@
+#ifndef TRAINER_HPP
+#define TRAINER_HPP
+
+#include <vector>
+#include <functional>
+#include <random>
+#include "neural_network.hpp"
+#include "optimizer.hpp"
+
+// Called after each trained batch with the index of the next batch
+typedef std::function<void(size_t)> BatchCallback;
+
+// Run one epoch of mini-batch training over the samples in `order`, starting at start_batch.
+// Loss and correct predictions are accumulated into epoch_loss and correct.
+void train_epoch(NeuralNetwork& model, Optimizer& optimizer,
+                 const std::vector<std::vector<float>>& train_images,
+                 const std::vector<std::vector<float>>& one_hot_train_labels,
+                 const std::vector<size_t>& order, int batch_size, size_t start_batch,
+                 float& epoch_loss, int& correct, const BatchCallback& on_batch = BatchCallback());
+
+// Number of correct predictions over the samples in `indices`, forwarded batch_size at a time
+int count_correct(NeuralNetwork& model,
+                  const std::vector<std::vector<float>>& images,
+                  const std::vector<std::vector<float>>& one_hot_labels,
+                  const std::vector<size_t>& indices, int batch_size);
+
+// Random sample order over [0, size)
+std::vector<size_t> shuffled_order(size_t size, std::mt19937& rng);
+
+#endif // TRAINER_HPP
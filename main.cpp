@@ -2,51 +2,282 @@
 #include <vector>
 #include <string>
 #include <cstring>
+#include <cmath>
+#include <chrono>
+#include <fstream>
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <numeric>
+#include <sstream>
+#include <thread>
+#include <atomic>
 #include <omp.h>
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#endif
 #include "./include/mnist_loader.hpp"
 #include "./include/neural_network.hpp"
 #include "./include/loss.hpp"
 #include "./include/optimizer.hpp"
 #include "./include/utils.hpp"
+#include "./include/checkpoint.hpp"
+#include "./include/autotune.hpp"
+#include "./include/trainer.hpp"
+#include "./include/sweep.hpp"
+#include "./include/cascade.hpp"
+#include "./include/online.hpp"
+#include "./include/hot_reload.hpp"
 
-int main(int argc, char* argv[]) {
-    // Set the number of threads to the number of available cores
-    int num_threads = omp_get_max_threads();
-    omp_set_num_threads(num_threads);
-    std::cout << "Using " << num_threads << " OpenMP threads." << std::endl;
+// Define the neural network architecture. Sparse models use SparseDenseLayers in place of DenseLayers.
+// The small model is the cheap first stage of the cascade.
+static void build_model(NeuralNetwork& model, bool sparse, bool small = false) {
+    auto dense = [sparse](int input_size, int output_size) -> Layer* {
+        if (sparse) {
+            return new SparseDenseLayer(input_size, output_size);
+        }
+        return new DenseLayer(input_size, output_size);
+    };
+
+    if (small) {
+        model.add_layer(dense(784, 128));  // Input to Hidden Layer
+        model.add_layer(new ActivationLayer("relu"));  // Activation Function
+        model.add_layer(dense(128, 10));    // Hidden to Output Layer
+        model.add_layer(new ActivationLayer("softmax"));  // Softmax Activation
+        return;
+    }
+
+    model.add_layer(dense(784, 1024));  // Input to Hidden Layer
+    model.add_layer(new ActivationLayer("relu"));  // Activation Function
+    model.add_layer(dense(1024, 1024));   // Hidden Layer
+    model.add_layer(new ActivationLayer("relu"));  // Activation Function
+    model.add_layer(dense(1024, 1024));   // Hidden Layer
+    model.add_layer(new ActivationLayer("relu"));  // Activation Function
+    model.add_layer(dense(1024, 1024));   // Hidden Layer
+    model.add_layer(new ActivationLayer("relu"));  // Activation Function
+    model.add_layer(dense(1024, 10));    // Hidden to Output Layer
+    model.add_layer(new ActivationLayer("softmax"));  // Softmax Activation
+}
+
+// Per-DenseLayer pruning targets: prune the hidden layers, keep the small output layer dense
+static std::vector<float> layer_sparsities(const NeuralNetwork& model, float sparsity) {
+    std::vector<float> targets(model.sparsities().size(), sparsity);
+    targets.back() = 0.0f;
+    return targets;
+}
+
+// Gradual pruning schedule (Zhu & Gupta): ramps cubically from 0 to target over ramp_steps
+static float scheduled_sparsity(float target, int step, int ramp_steps) {
+    if (step >= ramp_steps) {
+        return target;
+    }
+    float remaining = 1.0f - static_cast<float>(step) / ramp_steps;
+    return target * (1.0f - remaining * remaining * remaining);
+}
+
+// Print progress every 100 batches
+static void log_progress(size_t next_batch, size_t num_batches) {
+    size_t batch = next_batch - 1;
+    if (batch % 100 == 0) {
+        std::cout << "Processing batch " << batch << "/" << num_batches << std::endl;
+    }
+}
+
+static std::string serialize_rng(const std::mt19937& rng) {
+    std::ostringstream os;
+    os << rng;
+    return os.str();
+}
+
+// Forward the test set once, returning accuracy (%) and wall time (ms)
+static float timed_accuracy(NeuralNetwork& model, const std::vector<std::vector<float>>& images,
+                            const std::vector<std::vector<float>>& one_hot_labels, double& elapsed_ms) {
+    auto start = std::chrono::steady_clock::now();
+    auto predictions = model.forward(images);
+    elapsed_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return static_cast<float>(calculate_batch_accuracy(predictions, one_hot_labels)) / images.size() * 100.0f;
+}
+
+static long file_size(const std::string& path) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    return file.is_open() ? static_cast<long>(file.tellg()) : -1;
+}
 
+int main(int argc, char* argv[]) {
     try {
         // Check for mode argument
         if (argc < 2) {
-            std::cerr << "Usage: " << argv[0] << " [train|evaluate]" << std::endl;
+            std::cerr << "Usage: " << argv[0] << " [train|evaluate|prune|autotune|sweep|calibrate|cascade|online|stream|serve] [--small] [--sparsity S] [--sparse] [--finetune-epochs N] [--resume] [--checkpoint-every N] [--lr-scaling none|linear|sqrt] [--trial-seconds S] [--config PATH] [--target-accuracy A] [--margin] [--input PATH] [--output PATH] [--buffer N] [--update-every N] [--eval-every N] [--holdout N] [--passes N] [--duration S] [--clients N] [--canary N] [--min-canary-accuracy A] [--poll-ms N]" << std::endl;
             return 1;
         }
 
         std::string mode = argv[1];
         bool is_train_mode = false;
         bool is_evaluate_mode = false;
+        bool is_prune_mode = false;
+        bool is_autotune_mode = false;
+        bool is_sweep_mode = false;
+        bool is_calibrate_mode = false;
+        bool is_cascade_mode = false;
+        bool is_online_mode = false;
+        bool is_stream_mode = false;
+        bool is_serve_mode = false;
 
         if (mode == "train") {
             is_train_mode = true;
         } else if (mode == "evaluate") {
             is_evaluate_mode = true;
+        } else if (mode == "prune") {
+            is_prune_mode = true;
+        } else if (mode == "autotune") {
+            is_autotune_mode = true;
+        } else if (mode == "sweep") {
+            is_sweep_mode = true;
+        } else if (mode == "calibrate") {
+            is_calibrate_mode = true;
+        } else if (mode == "cascade") {
+            is_cascade_mode = true;
+        } else if (mode == "online") {
+            is_online_mode = true;
+        } else if (mode == "stream") {
+            is_stream_mode = true;
+        } else if (mode == "serve") {
+            is_serve_mode = true;
         } else {
-            std::cerr << "Invalid mode. Use 'train' or 'evaluate'." << std::endl;
+            std::cerr << "Invalid mode. Use 'train', 'evaluate', 'prune', 'autotune', 'sweep', 'calibrate', 'cascade', 'online', 'stream' or 'serve'." << std::endl;
             return 1;
         }
 
+        // stream writes records to stdout, so its log messages go to stderr
+        std::ostream record_output(std::cout.rdbuf());
+        if (is_stream_mode) {
+            std::cout.rdbuf(std::cerr.rdbuf());
+#ifdef _WIN32
+            _setmode(_fileno(stdout), _O_BINARY);
+#endif
+        }
+
+        // Optional arguments
+        float target_sparsity = 0.0f;   // train: iterative magnitude pruning target for hidden layers
+        bool use_sparse_model = false;  // evaluate: load the block-sparse model
+        int finetune_epochs = 1;        // prune: fine-tuning epochs per sparsity level
+        bool resume = false;            // train: continue from the last checkpoint; online: start from the trained model
+        int checkpoint_every = 500;     // train: batches between checkpoints (0 disables)
+        std::string lr_scaling;         // learning-rate rule for the tuned batch size (overrides the profile)
+        double trial_seconds = 0.5;     // autotune: minimum duration of each timed trial
+        std::string sweep_config_path = "sweep.cfg"; // sweep: runs to train
+        bool use_small_model = false;   // train/evaluate/prune/autotune: the cascade's small first-stage model
+        float target_accuracy = 98.0f;  // calibrate: cascade accuracy (%) to reach on the test set
+        bool use_margin = false;        // calibrate: escalate on top-2 margin instead of top probability
+        std::string input_path;         // online: record stream to read (stdin if empty)
+        std::string output_path;        // online: model file saved at every evaluation
+        OnlineOptions online_options;   // online: replay buffer and update/evaluation intervals
+        size_t holdout_size = 1000;     // online: test samples used for periodic evaluation
+        int passes = 1;                 // stream: shuffled passes over the training set (0 = until the reader stops)
+        double duration = 60.0;         // serve: seconds to run the request load
+        int clients = 4;                // serve: concurrent request threads
+        size_t canary_size = 500;       // serve: test samples every new model version is validated on
+        float min_canary_accuracy = 90.0f; // serve: canary accuracy (%) a new version needs to be swapped in
+        int poll_ms = 200;              // serve: model file polling interval
+        for (int a = 2; a < argc; ++a) {
+            std::string arg = argv[a];
+            if (arg == "--sparsity" && a + 1 < argc) {
+                target_sparsity = std::stof(argv[++a]);
+            } else if (arg == "--sparse") {
+                use_sparse_model = true;
+            } else if (arg == "--finetune-epochs" && a + 1 < argc) {
+                finetune_epochs = std::stoi(argv[++a]);
+            } else if (arg == "--resume") {
+                resume = true;
+            } else if (arg == "--checkpoint-every" && a + 1 < argc) {
+                checkpoint_every = std::stoi(argv[++a]);
+            } else if (arg == "--lr-scaling" && a + 1 < argc) {
+                lr_scaling = argv[++a];
+            } else if (arg == "--trial-seconds" && a + 1 < argc) {
+                trial_seconds = std::stod(argv[++a]);
+            } else if (arg == "--config" && a + 1 < argc) {
+                sweep_config_path = argv[++a];
+            } else if (arg == "--small") {
+                use_small_model = true;
+            } else if (arg == "--target-accuracy" && a + 1 < argc) {
+                target_accuracy = std::stof(argv[++a]);
+            } else if (arg == "--margin") {
+                use_margin = true;
+            } else if (arg == "--input" && a + 1 < argc) {
+                input_path = argv[++a];
+            } else if (arg == "--output" && a + 1 < argc) {
+                output_path = argv[++a];
+            } else if (arg == "--buffer" && a + 1 < argc) {
+                online_options.buffer_size = std::stoul(argv[++a]);
+            } else if (arg == "--update-every" && a + 1 < argc) {
+                online_options.update_every = std::stoul(argv[++a]);
+            } else if (arg == "--eval-every" && a + 1 < argc) {
+                online_options.eval_every = std::stoul(argv[++a]);
+            } else if (arg == "--holdout" && a + 1 < argc) {
+                holdout_size = std::stoul(argv[++a]);
+            } else if (arg == "--passes" && a + 1 < argc) {
+                passes = std::stoi(argv[++a]);
+            } else if (arg == "--duration" && a + 1 < argc) {
+                duration = std::stod(argv[++a]);
+            } else if (arg == "--clients" && a + 1 < argc) {
+                clients = std::stoi(argv[++a]);
+            } else if (arg == "--canary" && a + 1 < argc) {
+                canary_size = std::stoul(argv[++a]);
+            } else if (arg == "--min-canary-accuracy" && a + 1 < argc) {
+                min_canary_accuracy = std::stof(argv[++a]);
+            } else if (arg == "--poll-ms" && a + 1 < argc) {
+                poll_ms = std::stoi(argv[++a]);
+            } else {
+                std::cerr << "Unknown argument: " << arg << std::endl;
+                return 1;
+            }
+        }
+
         // Paths to MNIST dataset files
         const std::string train_images_path = "data/train-images.idx3-ubyte";
         const std::string train_labels_path = "data/train-labels.idx1-ubyte";
         const std::string test_images_path = "data/t10k-images.idx3-ubyte";
         const std::string test_labels_path = "data/t10k-labels.idx1-ubyte";
+        const std::string large_model_path = "mnist_model.bin";
+        const std::string small_model_path = "mnist_model_small.bin";
+        const std::string model_path = use_small_model ? small_model_path : large_model_path;
+        const std::string sparse_model_path = use_small_model ? "mnist_model_small_sparse.bin" : "mnist_model_sparse.bin";
+        const std::string checkpoint_path = use_small_model ? "mnist_checkpoint_small.bin" : "mnist_checkpoint.bin";
+        const std::string cascade_settings_path = "mnist_cascade.txt";
+        const std::string tuning_profile_path = use_small_model ? "mnist_tuning_small.txt" : "mnist_tuning.txt";
 
-        // Load and preprocess MNIST dataset
+        // Thread count, batch size and kernel tiling come from the autotuner's profile when present
+        TuningProfile profile;
+        if (!is_autotune_mode && load_tuning_profile(tuning_profile_path, profile)) {
+            std::cout << "Loaded tuning profile from " << tuning_profile_path << std::endl;
+        }
+        if (!lr_scaling.empty()) {
+            profile.lr_scaling = lr_scaling;
+        }
+        profile.scaled_learning_rate(0.1f); // Validate the scaling rule before loading data
+        profile.apply();
+        std::cout << "Using " << omp_get_max_threads() << " OpenMP threads." << std::endl;
+
+        // Load and preprocess MNIST dataset; online mode takes its training data from the stream
+        const bool needs_train_set = !is_evaluate_mode && !is_calibrate_mode && !is_cascade_mode && !is_online_mode && !is_serve_mode;
+        const bool needs_test_set = !is_autotune_mode && !is_stream_mode;
+        std::vector<std::vector<float>> train_images, test_images;
+        std::vector<int> train_labels, test_labels;
         std::cout << "Loading MNIST dataset..." << std::endl;
-        auto train_images = load_mnist_images(train_images_path);
-        auto train_labels = load_mnist_labels(train_labels_path);
-        auto test_images = load_mnist_images(test_images_path);
-        auto test_labels = load_mnist_labels(test_labels_path);
+        if (needs_train_set) {
+            train_images = load_mnist_images(train_images_path);
+            train_labels = load_mnist_labels(train_labels_path);
+        }
+        if (needs_test_set) {
+            test_images = load_mnist_images(test_images_path);
+            test_labels = load_mnist_labels(test_labels_path);
+        }
+        if (is_online_mode && holdout_size < test_images.size()) {
+            // Evaluation cost and memory stay fixed however long the stream runs
+            test_images.resize(holdout_size);
+            test_labels.resize(holdout_size);
+        }
         std::cout << "Dataset loaded successfully!" << std::endl;
 
         // Verify dataset sizes
@@ -55,6 +286,22 @@ int main(int argc, char* argv[]) {
         std::cout << "Number of test images: " << test_images.size() << std::endl;
         std::cout << "Number of test labels: " << test_labels.size() << std::endl;
 
+        if (is_stream_mode) {
+            // Replay the raw training set as a record stream, reshuffled on every pass
+            std::mt19937 rng(std::random_device{}());
+            uint32_t count = passes > 0 ? static_cast<uint32_t>(passes * train_images.size()) : 0;
+            write_mnist_stream_header(record_output, count, 28, 28);
+            for (int pass = 0; passes <= 0 || pass < passes; ++pass) {
+                for (size_t i : shuffled_order(train_images.size(), rng)) {
+                    write_mnist_record(record_output, train_images[i], train_labels[i]);
+                }
+                if (!record_output.flush()) {
+                    break;  // The reader closed the pipe
+                }
+            }
+            return 0;
+        }
+
         // Normalize image pixel values to [0, 1]
         normalize_images(train_images);
         normalize_images(test_images);
@@ -63,80 +310,116 @@ int main(int argc, char* argv[]) {
         auto one_hot_train_labels = one_hot_encode(train_labels, 10);
         auto one_hot_test_labels = one_hot_encode(test_labels, 10);
 
-        // Define the neural network architecture
-        std::cout << "Initializing neural network..." << std::endl;
+        // Define the neural network architecture (sweeps build their own)
         NeuralNetwork model;
-        model.add_layer(new DenseLayer(784, 1024));  // Input to Hidden Layer
-        model.add_layer(new ActivationLayer("relu"));  // Activation Function
-        model.add_layer(new DenseLayer(1024, 1024));   // Hidden Layer
-        model.add_layer(new ActivationLayer("relu"));  // Activation Function
-        model.add_layer(new DenseLayer(1024, 1024));   // Hidden Layer
-        model.add_layer(new ActivationLayer("relu"));  // Activation Function
-        model.add_layer(new DenseLayer(1024, 1024));   // Hidden Layer
-        model.add_layer(new ActivationLayer("relu"));  // Activation Function
-        model.add_layer(new DenseLayer(1024, 10));    // Hidden to Output Layer
-        model.add_layer(new ActivationLayer("softmax"));  // Softmax Activation
+        if (!is_sweep_mode && !is_serve_mode) {
+            std::cout << "Initializing neural network..." << std::endl;
+            build_model(model, is_evaluate_mode && use_sparse_model, use_small_model && !is_calibrate_mode && !is_cascade_mode);
+        }
 
-        if (is_evaluate_mode) {
+        if (is_evaluate_mode || is_prune_mode || is_calibrate_mode || is_cascade_mode || (is_online_mode && resume)) {
             // Load the saved model
-            std::cout << "Loading the saved model from mnist_model.bin..." << std::endl;
-            model.load("mnist_model.bin");
+            const std::string& path = (is_evaluate_mode && use_sparse_model) ? sparse_model_path
+                                    : (is_calibrate_mode || is_cascade_mode) ? large_model_path : model_path;
+            std::cout << "Loading the saved model from " << path << "..." << std::endl;
+            model.load(path);
             std::cout << "Model loaded successfully!" << std::endl;
+            if (!is_online_mode) {
+                // Evaluation runs on the packed layout; online training updates the weights and never uses it
+                model.pack();
+            }
         }
 
         if (is_train_mode) {
-            // Loss function
-            CrossEntropyLoss loss_function;
-
             // Optimizer
-            SGDOptimizer optimizer(0.1);  // Learning rate = 0.1
-
             // Training parameters
             const int epochs = 10;
-            const int batch_size = 32;
+            int batch_size = profile.batch_size;
 
-            // Training loop
-            std::cout << "Starting training..." << std::endl;
-            for (int epoch = 0; epoch < epochs; ++epoch) {
-                std::cout << "Epoch " << (epoch + 1) << "/" << epochs << " started." << std::endl;
-                float epoch_loss = 0.0;
-                int correct = 0;
+            // Optimizer; learning rate 0.1 at batch size 32, scaled for the tuned batch size
+            SGDOptimizer optimizer(profile.scaled_learning_rate(0.1f));
 
-                for (size_t i = 0; i < train_images.size(); i += batch_size) {
-                    if (i % (batch_size * 100) == 0) { // Print every 100 batches
-                        std::cout << "Processing batch " << (i / batch_size) << "/" << (train_images.size() / batch_size) << std::endl;
-                    }
+            // With pruning, sparsity ramps up until the last epoch, which fine-tunes at the target
+            const int prune_ramp_epochs = std::max(1, epochs - 1);
 
-                    // Create mini-batch
-                    size_t end = std::min(i + batch_size, train_images.size());
-                    std::vector<std::vector<float>> batch_inputs(train_images.begin() + i, train_images.begin() + end);
-                    std::vector<std::vector<float>> batch_labels(one_hot_train_labels.begin() + i, one_hot_train_labels.begin() + end);
+            // Training position; restored from the checkpoint when resuming
+            TrainingState state;
+            std::mt19937 rng(std::random_device{}());
+            bool resumed = resume && load_checkpoint(checkpoint_path, model, optimizer, state, train_images.size());
+            if (resume && !resumed) {
+                std::cout << "No checkpoint at " << checkpoint_path << "; starting training from scratch" << std::endl;
+            }
+            if (resumed) {
+                // The batch cursor and learning rate only make sense with the batch size they were saved with
+                std::istringstream(state.rng_state) >> rng;
+                if (state.batch_size != batch_size) {
+                    std::cout << "Checkpoint was written with batch size " << state.batch_size
+                              << "; resuming with it instead of the profile's " << batch_size << std::endl;
+                    batch_size = state.batch_size;
+                }
+                std::cout << "Resumed from " << checkpoint_path << " at epoch " << (state.epoch + 1)
+                          << ", batch " << state.next_batch << std::endl;
+            } else {
+                state.batch_size = batch_size;
+                state.order = shuffled_order(train_images.size(), rng);
+                state.rng_state = serialize_rng(rng);
+            }
+            std::cout << "Batch size " << batch_size << ", learning rate " << optimizer.get_learning_rate() << std::endl;
 
-                    // Forward pass
-                    auto predictions = model.forward(batch_inputs);
+            // Snapshots are taken in memory between batches and written to disk in the background
+            CheckpointWriter checkpoints(checkpoint_path);
+            BatchCallback on_batch = [&](size_t next_batch) {
+                log_progress(next_batch, train_images.size() / batch_size);
+                state.next_batch = next_batch;
+                if (checkpoint_every > 0 && next_batch % checkpoint_every == 0) {
+                    auto start = std::chrono::steady_clock::now();
+                    checkpoints.submit(model, optimizer, state);
+                    double pause_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+                    std::cout << "Checkpoint at batch " << next_batch << " (snapshot " << pause_ms << " ms)" << std::endl;
+                }
+            };
 
-                    // Calculate loss and accumulate
-                    epoch_loss += loss_function.calculate_loss(predictions, batch_labels);
+            // Training loop
+            std::cout << "Starting training..." << std::endl;
+            while (state.epoch < epochs) {
+                const int epoch = state.epoch;
+                std::cout << "Epoch " << (epoch + 1) << "/" << epochs << " started." << std::endl;
+                if (target_sparsity > 0.0f && epoch > 0) {
+                    // Also restores the pruning mask after resuming, since masks are not checkpointed
+                    float sparsity = scheduled_sparsity(target_sparsity, epoch, prune_ramp_epochs);
+                    model.prune(layer_sparsities(model, sparsity));
+                    std::cout << "Pruned hidden layers to " << sparsity * 100.0f << "% sparsity" << std::endl;
+                }
 
-                    // Backward pass
-                    auto gradients = loss_function.calculate_gradient(predictions, batch_labels);
-                    model.backward(gradients);
+                train_epoch(model, optimizer, train_images, one_hot_train_labels, state.order, batch_size,
+                            state.next_batch, state.epoch_loss, state.correct, on_batch);
 
-                    // Update weights
-                    model.update(optimizer);
+                // Log epoch metrics
+                std::cout << "Epoch [" << (epoch + 1) << "/" << epochs << "] - Loss: " << state.epoch_loss / train_images.size()
+                          << ", Accuracy: " << (static_cast<float>(state.correct) / train_images.size()) * 100.0 << "%" << std::endl;
 
-                    // Calculate accuracy for the batch
-                    correct += calculate_batch_accuracy(predictions, batch_labels);
+                // Advance to the next epoch and checkpoint the boundary
+                state.epoch = epoch + 1;
+                state.next_batch = 0;
+                state.epoch_loss = 0.0f;
+                state.correct = 0;
+                state.order = shuffled_order(train_images.size(), rng);
+                state.rng_state = serialize_rng(rng);
+                if (checkpoint_every > 0) {
+                    checkpoints.submit(model, optimizer, state);
                 }
-
-                // Log epoch metrics
-                std::cout << "Epoch [" << (epoch + 1) << "/" << epochs << "] - Loss: " << epoch_loss / train_images.size()
-                          << ", Accuracy: " << (static_cast<float>(correct) / train_images.size()) * 100.0 << "%" << std::endl;
             }
+            checkpoints.wait();
 
             // Save the model
-            model.save("mnist_model.bin");
-            std::cout << "Model saved to mnist_model.bin" << std::endl;
+            model.save(model_path);
+            std::cout << "Model saved to " << model_path << std::endl;
+
+            if (target_sparsity > 0.0f) {
+                model.sparsify();
+                model.save(sparse_model_path);
+                std::cout << "Sparse model saved to " << sparse_model_path << std::endl;
+            }
         }
 
         if (is_evaluate_mode) {
@@ -151,6 +434,229 @@ int main(int argc, char* argv[]) {
                       << ", Test Accuracy: " << (static_cast<float>(test_correct) / test_images.size()) * 100.0 << "%" << std::endl;
         }
 
+        if (is_prune_mode) {
+            // Iterative magnitude pruning of the trained model: each level starts from the previous one
+            SGDOptimizer optimizer(profile.scaled_learning_rate(0.01f));  // Lower learning rate for fine-tuning
+            const int batch_size = profile.batch_size;
+            const std::vector<float> levels = {0.8f, 0.9f, 0.95f};
+            std::mt19937 rng(std::random_device{}());
+
+            double dense_ms = 0.0;
+            float dense_accuracy = timed_accuracy(model, test_images, one_hot_test_labels, dense_ms);
+            long dense_bytes = file_size(model_path);
+
+            struct PruneResult { float sparsity, accuracy; double sparse_ms; long sparse_bytes; };
+            std::vector<PruneResult> results;
+
+            for (float level : levels) {
+                std::cout << "Pruning hidden layers to " << level * 100.0f << "% sparsity..." << std::endl;
+                model.prune(layer_sparsities(model, level));
+                for (int epoch = 0; epoch < finetune_epochs; ++epoch) {
+                    float epoch_loss = 0.0f;
+                    int correct = 0;
+                    train_epoch(model, optimizer, train_images, one_hot_train_labels,
+                                shuffled_order(train_images.size(), rng), batch_size, 0, epoch_loss, correct,
+                                [&](size_t next_batch) { log_progress(next_batch, train_images.size() / batch_size); });
+                    std::cout << "Fine-tune epoch [" << (epoch + 1) << "/" << finetune_epochs << "] - Loss: "
+                              << epoch_loss / train_images.size() << std::endl;
+                }
+
+                // Round-trip through the sparse format so size and accuracy reflect the deployed model
+                std::string level_path = (use_small_model ? "mnist_model_small_sparse_" : "mnist_model_sparse_") + std::to_string(static_cast<int>(std::lround(level * 100))) + ".bin";
+                std::stringstream pruned(std::ios::in | std::ios::out | std::ios::binary);
+                model.save(pruned);
+                NeuralNetwork sparse_model;
+                build_model(sparse_model, false, use_small_model);
+                sparse_model.load(pruned);
+                sparse_model.sparsify();
+                sparse_model.save(level_path);
+
+                NeuralNetwork deployed;
+                build_model(deployed, true, use_small_model);
+                deployed.load(level_path);
+
+                PruneResult result;
+                result.sparsity = level;
+                result.accuracy = timed_accuracy(deployed, test_images, one_hot_test_labels, result.sparse_ms);
+                result.sparse_bytes = file_size(level_path);
+                results.push_back(result);
+                std::cout << "Sparse model saved to " << level_path << std::endl;
+            }
+
+            std::cout << "\nSparsity | Accuracy | Test forward (ms) | Speedup | Model size (bytes) | Size reduction" << std::endl;
+            std::cout << "dense    | " << dense_accuracy << "% | " << dense_ms << " | 1.00x | " << dense_bytes << " | 1.00x" << std::endl;
+            for (const auto& r : results) {
+                std::cout << r.sparsity * 100.0f << "%      | " << r.accuracy << "% | " << r.sparse_ms << " | "
+                          << dense_ms / r.sparse_ms << "x | " << r.sparse_bytes << " | "
+                          << static_cast<double>(dense_bytes) / r.sparse_bytes << "x" << std::endl;
+            }
+        }
+
+        if (is_autotune_mode) {
+            // Timed trials on this machine and model shape; training and evaluation pick the profile up automatically
+            std::cout << "Autotuning batch size, threads and kernel tiling..." << std::endl;
+            TuningProfile tuned = autotune(model, train_images, one_hot_train_labels, profile, trial_seconds);
+            save_tuning_profile(tuning_profile_path, tuned);
+            std::cout << "Tuning profile saved to " << tuning_profile_path << ": batch size " << tuned.batch_size
+                      << ", threads " << tuned.num_threads << ", tiles " << tuned.tiling.batch_tile << "x"
+                      << tuned.tiling.input_tile << "x" << tuned.tiling.output_tile
+                      << ", learning rate " << tuned.scaled_learning_rate(0.1f) << " (" << tuned.lr_scaling << " scaling)" << std::endl;
+        }
+
+        if (is_sweep_mode) {
+            // Train every configured variant concurrently on the dataset loaded above
+            SweepConfig config = load_sweep_config(sweep_config_path);
+            auto start = std::chrono::steady_clock::now();
+            std::vector<SweepResult> results = run_sweep(config, train_images, one_hot_train_labels,
+                                                         test_images, one_hot_test_labels);
+            double wall_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+            size_t dataset_bytes = 0;
+            for (const auto* rows : {&train_images, &one_hot_train_labels, &test_images, &one_hot_test_labels}) {
+                dataset_bytes += rows->size() * (*rows)[0].size() * sizeof(float);
+            }
+            size_t parameter_bytes = 0;
+
+            std::cout << "\nRun | Epochs | Validation Accuracy | Test Accuracy | Train time (s)" << std::endl;
+            for (const auto& r : results) {
+                std::cout << r.name << " | " << r.epochs_trained << (r.stopped_early ? " (stopped)" : "") << " | "
+                          << r.validation_accuracy << "% | " << r.test_accuracy << "% | " << r.seconds << std::endl;
+                parameter_bytes += r.parameter_bytes;
+            }
+            std::cout << "Sweep wall time: " << wall_seconds << " s" << std::endl;
+            std::cout << "Dataset: " << dataset_bytes / (1024.0 * 1024.0) << " MiB shared by " << results.size()
+                      << " runs; model parameters: " << parameter_bytes / (1024.0 * 1024.0) << " MiB total" << std::endl;
+        }
+
+        if (is_online_mode) {
+            // Learn from records as they arrive on stdin or a FIFO. The model is saved at every evaluation
+            // (and at the end of the stream) to its own file, so the trained model is never overwritten by default.
+            if (output_path.empty()) {
+                output_path = use_small_model ? "mnist_model_small_online.bin" : "mnist_model_online.bin";
+            }
+            online_options.batch_size = profile.batch_size;
+            SGDOptimizer optimizer(profile.scaled_learning_rate(0.1f));
+            std::ifstream input_file;
+            if (!input_path.empty()) {
+                input_file.open(input_path, std::ios::binary);
+                if (!input_file.is_open()) {
+                    throw std::runtime_error("Unable to open file: " + input_path);
+                }
+            } else {
+#ifdef _WIN32
+                _setmode(_fileno(stdin), _O_BINARY);
+#endif
+            }
+            std::istream& input = input_path.empty() ? std::cin : input_file;
+
+            std::cout << "Waiting for records on " << (input_path.empty() ? "stdin" : input_path) << "..." << std::endl;
+            MnistStreamReader stream(input);
+            OnlineStats stats = train_online(model, optimizer, stream, test_images, one_hot_test_labels, online_options,
+                                             [&](const OnlineStats&) { save_model_atomic(output_path, model); });
+            std::cout << "Stream ended after " << stats.records << " records and " << stats.updates
+                      << " updates; model saved to " << output_path << std::endl;
+        }
+
+        if (is_serve_mode) {
+            // Request load against a hot-reloaded model: overwrite the model file while this runs to
+            // check that new weights are swapped in without failing or stalling requests
+            if (canary_size == 0 || canary_size >= test_images.size()) {
+                throw std::invalid_argument("--canary must be between 1 and the test set size");
+            }
+            std::vector<std::vector<float>> canary_images(test_images.begin(), test_images.begin() + canary_size);
+            std::vector<std::vector<float>> canary_labels(one_hot_test_labels.begin(), one_hot_test_labels.begin() + canary_size);
+            auto factory = [use_sparse_model, use_small_model](NeuralNetwork& m) { build_model(m, use_sparse_model, use_small_model); };
+            const std::string& path = use_sparse_model ? sparse_model_path : model_path;
+
+            std::cout << "Serving " << path << " with " << clients << " clients for " << duration << " s..." << std::endl;
+            HotReloadModel server(path, factory, canary_images, canary_labels, min_canary_accuracy, poll_ms);
+
+            // Clients send batches from the rest of the test set and check every response
+            const size_t batch_size = static_cast<size_t>(profile.batch_size);
+            std::atomic<long> served(0), failed(0);
+            std::vector<std::vector<double>> latencies(clients);
+            auto deadline = std::chrono::steady_clock::now() + std::chrono::duration<double>(duration);
+            std::vector<std::thread> threads;
+            for (int c = 0; c < clients; ++c) {
+                threads.emplace_back([&, c]() {
+                    size_t i = canary_size + c * batch_size;
+                    while (std::chrono::steady_clock::now() < deadline) {
+                        if (i + batch_size > test_images.size()) {
+                            i = canary_size;
+                        }
+                        std::vector<std::vector<float>> batch(test_images.begin() + i, test_images.begin() + std::min(i + batch_size, test_images.size()));
+                        i += clients * batch_size;
+
+                        auto start = std::chrono::steady_clock::now();
+                        bool ok = true;
+                        try {
+                            auto outputs = server.forward(batch);
+                            ok = outputs.size() == batch.size();
+                            for (size_t n = 0; ok && n < outputs.size(); ++n) {
+                                float sum = std::accumulate(outputs[n].begin(), outputs[n].end(), 0.0f);
+                                ok = outputs[n].size() == 10 && std::fabs(sum - 1.0f) < 1e-3f;
+                            }
+                        } catch (const std::exception&) {
+                            ok = false;
+                        }
+                        latencies[c].push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+                        if (ok) {
+                            ++served;
+                        } else {
+                            ++failed;
+                        }
+                    }
+                });
+            }
+            for (std::thread& t : threads) {
+                t.join();
+            }
+
+            std::vector<double> all;
+            for (const auto& l : latencies) {
+                all.insert(all.end(), l.begin(), l.end());
+            }
+            std::sort(all.begin(), all.end());
+            ReloadStats stats = server.stats();
+            std::cout << "Requests: " << served << " served, " << failed << " failed" << std::endl;
+            if (!all.empty()) {
+                std::cout << "Latency: p50 " << all[all.size() / 2] << " ms, p99 " << all[all.size() * 99 / 100]
+                          << " ms, max " << all.back() << " ms (batch size " << batch_size << ")" << std::endl;
+            }
+            std::cout << "Reloads: " << stats.reloads << " swapped in, " << stats.rejected << " rejected; max load "
+                      << stats.max_load_ms << " ms, max swap " << stats.max_swap_us << " us" << std::endl;
+            if (failed > 0) {
+                return 1;
+            }
+        }
+
+        if (is_calibrate_mode || is_cascade_mode) {
+            // The small model screens every sample; only low-confidence ones reach the full model
+            NeuralNetwork small_model;
+            build_model(small_model, false, true);
+            std::cout << "Loading the small model from " << small_model_path << "..." << std::endl;
+            small_model.load(small_model_path);
+            small_model.pack();
+
+            CascadeSettings settings;
+            if (is_calibrate_mode) {
+                settings.measure = use_margin ? ConfidenceMeasure::Margin : ConfidenceMeasure::TopProbability;
+                settings.threshold = calibrate_cascade_threshold(small_model, model, test_images, one_hot_test_labels,
+                                                                 target_accuracy, settings.measure);
+                save_cascade_settings(cascade_settings_path, settings);
+                std::cout << "Threshold " << settings.threshold << " for " << target_accuracy
+                          << "% target accuracy saved to " << cascade_settings_path << std::endl;
+            } else if (!load_cascade_settings(cascade_settings_path, settings)) {
+                throw std::runtime_error("Missing " + cascade_settings_path + "; run calibrate first");
+            }
+
+            CascadeClassifier cascade(small_model, model, settings.threshold, settings.measure);
+            CascadeReport report = measure_cascade(cascade, model, test_images, one_hot_test_labels, profile.batch_size);
+            std::cout << "Cascade Accuracy: " << report.accuracy << "%, Escalated: " << report.escalated_fraction * 100.0f
+                      << "%, Latency: " << report.latency_ms << " ms/batch (full model alone: "
+                      << report.large_latency_ms << " ms/batch, batch size " << profile.batch_size << ")" << std::endl;
+        }
+
     } catch (const std::exception& e) {
         std::cerr << "Error: " << e.what() << std::endl;
         return 1;
@@ -0,0 +1,194 @@
+#include "../include/autotune.hpp"
+#include "../include/loss.hpp"
+#include "../include/optimizer.hpp"
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <omp.h>
+
+namespace {
+
+// OpenMP's thread count before any profile was applied (honours OMP_NUM_THREADS)
+int default_thread_count() {
+    static const int threads = omp_get_max_threads();
+    return threads;
+}
+
+} // namespace
+
+float TuningProfile::scaled_learning_rate(float base_lr) const {
+    float ratio = static_cast<float>(batch_size) / static_cast<float>(base_batch_size);
+    if (lr_scaling == "none") {
+        return base_lr;
+    }
+    if (lr_scaling == "linear") {
+        return base_lr * ratio;
+    }
+    if (lr_scaling == "sqrt") {
+        return base_lr * std::sqrt(ratio);
+    }
+    throw std::invalid_argument("Unsupported learning rate scaling: " + lr_scaling);
+}
+
+void TuningProfile::apply() const {
+    omp_set_num_threads(num_threads > 0 ? num_threads : default_thread_count());
+    DenseLayer::set_tiling(tiling);
+}
+
+void save_tuning_profile(const std::string& path, const TuningProfile& profile) {
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to open file for saving: " + path);
+    }
+    file << "batch_size " << profile.batch_size << "\n"
+         << "num_threads " << profile.num_threads << "\n"
+         << "batch_tile " << profile.tiling.batch_tile << "\n"
+         << "input_tile " << profile.tiling.input_tile << "\n"
+         << "output_tile " << profile.tiling.output_tile << "\n"
+         << "lr_scaling " << profile.lr_scaling << "\n"
+         << "base_batch_size " << profile.base_batch_size << "\n";
+}
+
+bool load_tuning_profile(const std::string& path, TuningProfile& profile) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        return false;
+    }
+    std::string key;
+    while (file >> key) {
+        if (key == "batch_size") {
+            file >> profile.batch_size;
+        } else if (key == "num_threads") {
+            file >> profile.num_threads;
+        } else if (key == "batch_tile") {
+            file >> profile.tiling.batch_tile;
+        } else if (key == "input_tile") {
+            file >> profile.tiling.input_tile;
+        } else if (key == "output_tile") {
+            file >> profile.tiling.output_tile;
+        } else if (key == "lr_scaling") {
+            file >> profile.lr_scaling;
+        } else if (key == "base_batch_size") {
+            file >> profile.base_batch_size;
+        } else {
+            throw std::runtime_error("Unknown key '" + key + "' in tuning profile: " + path);
+        }
+    }
+    if (profile.batch_size <= 0 || profile.base_batch_size <= 0 || profile.tiling.batch_tile == 0 ||
+        profile.tiling.input_tile == 0 || profile.tiling.output_tile == 0) {
+        throw std::runtime_error("Invalid tuning profile: " + path);
+    }
+    return true;
+}
+
+namespace {
+
+// Training throughput (samples/s) of `profile`, measured over whole training steps
+double measure_throughput(NeuralNetwork& model,
+                          const std::vector<std::vector<float>>& images,
+                          const std::vector<std::vector<float>>& one_hot_labels,
+                          const TuningProfile& profile, double seconds_per_trial) {
+    profile.apply();
+    CrossEntropyLoss loss_function;
+    SGDOptimizer optimizer(0.0f); // Same work as a real update, but leaves the weights untouched
+
+    size_t cursor = 0;
+    auto step = [&]() {
+        std::vector<std::vector<float>> batch_inputs;
+        std::vector<std::vector<float>> batch_labels;
+        for (int n = 0; n < profile.batch_size; ++n) {
+            batch_inputs.push_back(images[cursor]);
+            batch_labels.push_back(one_hot_labels[cursor]);
+            cursor = (cursor + 1) % images.size();
+        }
+        auto predictions = model.forward(batch_inputs);
+        model.backward(loss_function.calculate_gradient(predictions, batch_labels));
+        model.update(optimizer);
+    };
+
+    step(); // Warm-up: first-touch allocations and thread pool start-up
+
+    const int min_steps = 2;
+    int steps = 0;
+    auto start = std::chrono::steady_clock::now();
+    double elapsed = 0.0;
+    while (steps < min_steps || elapsed < seconds_per_trial) {
+        step();
+        ++steps;
+        elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    double throughput = steps * profile.batch_size / elapsed;
+    std::cout << "  batch " << profile.batch_size << ", threads " << omp_get_max_threads()
+              << ", tiles " << profile.tiling.batch_tile << "x" << profile.tiling.input_tile << "x" << profile.tiling.output_tile
+              << ": " << throughput << " samples/s" << std::endl;
+    return throughput;
+}
+
+// Try each candidate value for one setting, keeping the fastest in `best`
+template <typename T, typename Setter>
+void tune_setting(const char* name, const std::vector<T>& candidates, Setter set,
+                  NeuralNetwork& model,
+                  const std::vector<std::vector<float>>& images,
+                  const std::vector<std::vector<float>>& one_hot_labels,
+                  TuningProfile& best, double& best_throughput, double seconds_per_trial) {
+    std::cout << "Tuning " << name << "..." << std::endl;
+    TuningProfile fastest = best;
+    for (const T& value : candidates) {
+        TuningProfile trial = best;
+        set(trial, value);
+        double throughput = measure_throughput(model, images, one_hot_labels, trial, seconds_per_trial);
+        if (throughput > best_throughput) {
+            best_throughput = throughput;
+            fastest = trial;
+        }
+    }
+    best = fastest;
+}
+
+} // namespace
+
+TuningProfile autotune(NeuralNetwork& model,
+                       const std::vector<std::vector<float>>& images,
+                       const std::vector<std::vector<float>>& one_hot_labels,
+                       const TuningProfile& initial,
+                       double seconds_per_trial) {
+    if (images.empty()) {
+        throw std::invalid_argument("Autotuning needs at least one training sample");
+    }
+
+    std::vector<int> thread_counts;
+    for (int threads = 1; threads < default_thread_count(); threads *= 2) {
+        thread_counts.push_back(threads);
+    }
+    thread_counts.push_back(default_thread_count());
+
+    const std::vector<int> batch_sizes = {16, 32, 64, 128, 256};
+    const std::vector<size_t> batch_tiles = {1, 2, 4, 8, 16};
+    const std::vector<size_t> input_tiles = {32, 64, 128, 256, 1024};
+    const std::vector<size_t> output_tiles = {64, 128, 256, 512, 1024};
+
+    TuningProfile best = initial;
+    double best_throughput = measure_throughput(model, images, one_hot_labels, best, seconds_per_trial);
+
+    auto tune_tiling = [&]() {
+        tune_setting("output tile", output_tiles, [](TuningProfile& p, size_t v) { p.tiling.output_tile = v; },
+                     model, images, one_hot_labels, best, best_throughput, seconds_per_trial);
+        tune_setting("input tile", input_tiles, [](TuningProfile& p, size_t v) { p.tiling.input_tile = v; },
+                     model, images, one_hot_labels, best, best_throughput, seconds_per_trial);
+        tune_setting("batch tile", batch_tiles, [](TuningProfile& p, size_t v) { p.tiling.batch_tile = v; },
+                     model, images, one_hot_labels, best, best_throughput, seconds_per_trial);
+    };
+
+    tune_tiling();
+    tune_setting("threads", thread_counts, [](TuningProfile& p, int v) { p.num_threads = v; },
+                 model, images, one_hot_labels, best, best_throughput, seconds_per_trial);
+    tune_setting("batch size", batch_sizes, [](TuningProfile& p, int v) { p.batch_size = v; },
+                 model, images, one_hot_labels, best, best_throughput, seconds_per_trial);
+    tune_tiling();
+
+    best.apply();
+    return best;
+}
@@ -0,0 +1,192 @@
+#include "../include/cascade.hpp"
+#include "../include/utils.hpp"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <numeric>
+#include <stdexcept>
+
+namespace {
+
+// Confidences never exceed 1, so this threshold escalates every sample
+const float ESCALATE_ALL = 2.0f;
+
+size_t argmax(const std::vector<float>& values) {
+    return std::distance(values.begin(), std::max_element(values.begin(), values.end()));
+}
+
+// Forward in batches to bound the memory of the cached activations
+std::vector<std::vector<float>> forward_batched(NeuralNetwork& model, const std::vector<std::vector<float>>& images,
+                                                size_t batch_size) {
+    std::vector<std::vector<float>> outputs;
+    outputs.reserve(images.size());
+    for (size_t i = 0; i < images.size(); i += batch_size) {
+        size_t end = std::min(i + batch_size, images.size());
+        std::vector<std::vector<float>> batch(images.begin() + i, images.begin() + end);
+        for (auto& row : model.forward(batch)) {
+            outputs.push_back(std::move(row));
+        }
+    }
+    return outputs;
+}
+
+} // namespace
+
+float confidence(const std::vector<float>& probabilities, ConfidenceMeasure measure) {
+    float top = -1.0f;
+    float second = -1.0f;
+    for (float p : probabilities) {
+        if (p > top) {
+            second = top;
+            top = p;
+        } else if (p > second) {
+            second = p;
+        }
+    }
+    return measure == ConfidenceMeasure::Margin ? top - std::max(second, 0.0f) : top;
+}
+
+CascadeClassifier::CascadeClassifier(NeuralNetwork& small_model, NeuralNetwork& large_model,
+                                     float threshold, ConfidenceMeasure measure)
+    : small_model(small_model), large_model(large_model), threshold(threshold), measure(measure) {}
+
+std::vector<std::vector<float>> CascadeClassifier::forward(const std::vector<std::vector<float>>& inputs, size_t* escalated) {
+    std::vector<std::vector<float>> outputs = small_model.forward(inputs);
+
+    // Gather the hard samples into one batch for the large model
+    std::vector<size_t> hard;
+    std::vector<std::vector<float>> hard_inputs;
+    for (size_t i = 0; i < outputs.size(); ++i) {
+        if (confidence(outputs[i], measure) < threshold) {
+            hard.push_back(i);
+            hard_inputs.push_back(inputs[i]);
+        }
+    }
+
+    if (!hard.empty()) {
+        std::vector<std::vector<float>> hard_outputs = large_model.forward(hard_inputs);
+        for (size_t n = 0; n < hard.size(); ++n) {
+            outputs[hard[n]] = std::move(hard_outputs[n]);
+        }
+    }
+
+    if (escalated != nullptr) {
+        *escalated = hard.size();
+    }
+    return outputs;
+}
+
+void save_cascade_settings(const std::string& path, const CascadeSettings& settings) {
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to open file for saving: " + path);
+    }
+    // Full precision, so the reloaded threshold splits the calibration set exactly as calibrated
+    file << std::setprecision(9) << "threshold " << settings.threshold << "\n"
+         << "measure " << (settings.measure == ConfidenceMeasure::Margin ? "margin" : "top_probability") << "\n";
+}
+
+bool load_cascade_settings(const std::string& path, CascadeSettings& settings) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        return false;
+    }
+    std::string key;
+    while (file >> key) {
+        if (key == "threshold") {
+            file >> settings.threshold;
+        } else if (key == "measure") {
+            std::string measure;
+            file >> measure;
+            if (measure == "margin") {
+                settings.measure = ConfidenceMeasure::Margin;
+            } else if (measure == "top_probability") {
+                settings.measure = ConfidenceMeasure::TopProbability;
+            } else {
+                throw std::runtime_error("Unknown confidence measure '" + measure + "' in " + path);
+            }
+        } else {
+            throw std::runtime_error("Unknown key '" + key + "' in cascade settings: " + path);
+        }
+    }
+    return true;
+}
+
+float calibrate_cascade_threshold(NeuralNetwork& small_model, NeuralNetwork& large_model,
+                                  const std::vector<std::vector<float>>& images,
+                                  const std::vector<std::vector<float>>& one_hot_labels,
+                                  float target_accuracy, ConfidenceMeasure measure) {
+    const size_t batch_size = 256;
+    std::vector<std::vector<float>> small_outputs = forward_batched(small_model, images, batch_size);
+    std::vector<std::vector<float>> large_outputs = forward_batched(large_model, images, batch_size);
+
+    const size_t n = images.size();
+    std::vector<float> confidences(n);
+    std::vector<int> small_correct(n);
+    std::vector<int> large_correct(n);
+    int total_small_correct = 0;
+    for (size_t i = 0; i < n; ++i) {
+        size_t label = argmax(one_hot_labels[i]);
+        confidences[i] = confidence(small_outputs[i], measure);
+        small_correct[i] = argmax(small_outputs[i]) == label;
+        large_correct[i] = argmax(large_outputs[i]) == label;
+        total_small_correct += small_correct[i];
+    }
+
+    // Escalating the m least confident samples gives
+    // correct(m) = large correct over the first m + small correct over the rest
+    std::vector<size_t> order(n);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&confidences](size_t a, size_t b) { return confidences[a] < confidences[b]; });
+
+    int correct = total_small_correct;
+    for (size_t m = 0; m <= n; ++m) {
+        // Only stop between distinct confidences, since the threshold cannot split ties
+        bool at_boundary = m == 0 || m == n || confidences[order[m]] > confidences[order[m - 1]];
+        if (at_boundary && 100.0f * correct / n >= target_accuracy) {
+            return m == 0 ? 0.0f : (m == n ? ESCALATE_ALL : confidences[order[m]]);
+        }
+        if (m < n) {
+            correct += large_correct[order[m]] - small_correct[order[m]];
+        }
+    }
+    return ESCALATE_ALL;
+}
+
+CascadeReport measure_cascade(CascadeClassifier& cascade, NeuralNetwork& large_model,
+                              const std::vector<std::vector<float>>& images,
+                              const std::vector<std::vector<float>>& one_hot_labels,
+                              int batch_size) {
+    CascadeReport report;
+    int correct = 0;
+    size_t escalated = 0;
+    size_t num_batches = 0;
+    double cascade_ms = 0.0;
+    double large_ms = 0.0;
+
+    for (size_t i = 0; i < images.size(); i += batch_size) {
+        size_t end = std::min(i + static_cast<size_t>(batch_size), images.size());
+        std::vector<std::vector<float>> batch_inputs(images.begin() + i, images.begin() + end);
+        std::vector<std::vector<float>> batch_labels(one_hot_labels.begin() + i, one_hot_labels.begin() + end);
+
+        size_t batch_escalated = 0;
+        auto start = std::chrono::steady_clock::now();
+        auto predictions = cascade.forward(batch_inputs, &batch_escalated);
+        auto middle = std::chrono::steady_clock::now();
+        large_model.forward(batch_inputs);
+        auto stop = std::chrono::steady_clock::now();
+
+        cascade_ms += std::chrono::duration<double, std::milli>(middle - start).count();
+        large_ms += std::chrono::duration<double, std::milli>(stop - middle).count();
+        correct += calculate_batch_accuracy(predictions, batch_labels);
+        escalated += batch_escalated;
+        ++num_batches;
+    }
+
+    report.accuracy = 100.0f * correct / images.size();
+    report.escalated_fraction = static_cast<float>(escalated) / images.size();
+    report.latency_ms = cascade_ms / num_batches;
+    report.large_latency_ms = large_ms / num_batches;
+    return report;
+}
@@ -0,0 +1,238 @@
+#include "../include/checkpoint.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <streambuf>
+#ifdef _WIN32
+#include <windows.h>
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace {
+
+const char CHECKPOINT_MAGIC[8] = {'M', 'N', 'I', 'S', 'T', 'C', 'K', 'P'};
+const uint32_t CHECKPOINT_VERSION = 2;
+
+// A serialized std::mt19937 is about 7 KB of text
+const size_t MAX_RNG_STATE_SIZE = 64 * 1024;
+
+// Stream buffer that appends to a std::vector<char>, reusing its capacity between snapshots
+class VectorStreamBuf : public std::streambuf {
+private:
+    std::vector<char>& buffer;
+
+protected:
+    int_type overflow(int_type ch) override {
+        if (ch != traits_type::eof()) {
+            buffer.push_back(static_cast<char>(ch));
+        }
+        return ch;
+    }
+
+    std::streamsize xsputn(const char* data, std::streamsize count) override {
+        buffer.insert(buffer.end(), data, data + count);
+        return count;
+    }
+
+public:
+    explicit VectorStreamBuf(std::vector<char>& buffer) : buffer(buffer) {}
+};
+
+template <typename T>
+void write_value(std::ostream& os, const T& value) {
+    os.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template <typename T>
+void read_value(std::istream& is, T& value) {
+    is.read(reinterpret_cast<char*>(&value), sizeof(value));
+}
+
+// Write the buffer to disk, flushed through to the device
+bool write_file(const std::string& path, const std::vector<char>& data) {
+    FILE* file = std::fopen(path.c_str(), "wb");
+    if (file == nullptr) {
+        return false;
+    }
+    bool ok = std::fwrite(data.data(), 1, data.size(), file) == data.size() && std::fflush(file) == 0;
+#ifdef _WIN32
+    ok = ok && _commit(_fileno(file)) == 0;
+#else
+    ok = ok && fsync(fileno(file)) == 0;
+#endif
+    return std::fclose(file) == 0 && ok;
+}
+
+// Atomically replace `to` with `from`
+bool replace_file(const std::string& from, const std::string& to) {
+#ifdef _WIN32
+    return MoveFileExA(from.c_str(), to.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+    return std::rename(from.c_str(), to.c_str()) == 0;
+#endif
+}
+
+} // namespace
+
+CheckpointWriter::CheckpointWriter(const std::string& path) : path(path) {
+    writer = std::thread(&CheckpointWriter::run, this);
+}
+
+CheckpointWriter::~CheckpointWriter() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    cv.notify_all();
+    writer.join();
+}
+
+void CheckpointWriter::submit(const NeuralNetwork& model, const Optimizer& optimizer, const TrainingState& state) {
+    {
+        // Take back a snapshot the writer has not started on; this one supersedes it
+        std::lock_guard<std::mutex> lock(mutex);
+        queued = false;
+    }
+
+    // Serialize into memory; this is the only part the training loop waits for
+    staging.clear();
+    VectorStreamBuf buf(staging);
+    std::ostream os(&buf);
+
+    os.write(CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC));
+    write_value(os, CHECKPOINT_VERSION);
+    write_value(os, state.epoch);
+    write_value(os, state.next_batch);
+    write_value(os, state.batch_size);
+    write_value(os, state.epoch_loss);
+    write_value(os, state.correct);
+
+    size_t rng_size = state.rng_state.size();
+    write_value(os, rng_size);
+    os.write(state.rng_state.data(), rng_size);
+
+    size_t order_size = state.order.size();
+    write_value(os, order_size);
+    os.write(reinterpret_cast<const char*>(state.order.data()), order_size * sizeof(size_t));
+
+    optimizer.save(os);
+    model.save(os);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        queued = true;
+    }
+    cv.notify_all();
+}
+
+void CheckpointWriter::wait() {
+    std::unique_lock<std::mutex> lock(mutex);
+    cv.wait(lock, [this] { return !queued && !busy; });
+}
+
+// Writer thread: persist the latest queued snapshot; a queued snapshot is still written when stopping
+void CheckpointWriter::run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        cv.wait(lock, [this] { return queued || stopping; });
+        if (!queued) {
+            return;
+        }
+        staging.swap(writing);
+        queued = false;
+        busy = true;
+
+        lock.unlock();
+        const std::string tmp_path = path + ".tmp";
+        if (!write_file(tmp_path, writing) || !replace_file(tmp_path, path)) {
+            std::cerr << "Failed to write checkpoint: " << path << std::endl;
+        }
+        lock.lock();
+
+        busy = false;
+        cv.notify_all();
+    }
+}
+
+void save_model_atomic(const std::string& path, const NeuralNetwork& model) {
+    std::vector<char> data;
+    VectorStreamBuf buf(data);
+    std::ostream os(&buf);
+    model.save(os);
+
+    const std::string tmp_path = path + ".tmp";
+    if (!write_file(tmp_path, data) || !replace_file(tmp_path, path)) {
+        throw std::runtime_error("Failed to save model: " + path);
+    }
+}
+
+bool load_checkpoint(const std::string& path, NeuralNetwork& model, Optimizer& optimizer, TrainingState& state,
+                     size_t num_samples) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    char magic[sizeof(CHECKPOINT_MAGIC)] = {};
+    uint32_t version = 0;
+    file.read(magic, sizeof(magic));
+    read_value(file, version);
+    if (std::memcmp(magic, CHECKPOINT_MAGIC, sizeof(magic)) != 0 || version != CHECKPOINT_VERSION) {
+        throw std::runtime_error("Not a compatible checkpoint: " + path);
+    }
+
+    read_value(file, state.epoch);
+    read_value(file, state.next_batch);
+    read_value(file, state.batch_size);
+    read_value(file, state.epoch_loss);
+    read_value(file, state.correct);
+
+    size_t rng_size = 0;
+    read_value(file, rng_size);
+    if (!file) {
+        throw std::runtime_error("Truncated checkpoint: " + path);
+    }
+    if (rng_size > MAX_RNG_STATE_SIZE) {
+        throw std::runtime_error("Corrupt RNG state in checkpoint: " + path);
+    }
+    state.rng_state.resize(rng_size);
+    file.read(&state.rng_state[0], rng_size);
+
+    // The cursor indexes the training set directly, so it must match the one being trained on
+    size_t order_size = 0;
+    read_value(file, order_size);
+    if (!file) {
+        throw std::runtime_error("Truncated checkpoint: " + path);
+    }
+    if (order_size != num_samples) {
+        throw std::runtime_error("Checkpoint " + path + " was written for a different training set (" +
+                                 std::to_string(order_size) + " samples, expected " + std::to_string(num_samples) + ")");
+    }
+    state.order.resize(order_size);
+    file.read(reinterpret_cast<char*>(state.order.data()), order_size * sizeof(size_t));
+
+    optimizer.load(file);
+    model.load(file);
+
+    if (!file) {
+        throw std::runtime_error("Truncated checkpoint: " + path);
+    }
+    if (state.batch_size <= 0) {
+        throw std::runtime_error("Invalid batch size in checkpoint: " + path);
+    }
+    size_t num_batches = (num_samples + state.batch_size - 1) / state.batch_size;
+    if (state.epoch < 0 || state.next_batch > num_batches) {
+        throw std::runtime_error("Training position out of range in checkpoint: " + path);
+    }
+    for (size_t index : state.order) {
+        if (index >= num_samples) {
+            throw std::runtime_error("Sample index out of range in checkpoint: " + path);
+        }
+    }
+    return true;
+}
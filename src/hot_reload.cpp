@@ -0,0 +1,172 @@
+#include "../include/hot_reload.hpp"
+#include "../include/trainer.hpp"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <numeric>
+#include <stdexcept>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/stat.h>
+#endif
+
+namespace {
+
+// Size and modification time of a file; equal signatures mean the file has not been rewritten
+struct FileSignature {
+    bool exists = false;
+    unsigned long long size = 0;
+    unsigned long long mtime = 0;           // Finest resolution the platform reports
+
+    bool operator==(const FileSignature& other) const {
+        return exists == other.exists && size == other.size && mtime == other.mtime;
+    }
+    bool operator!=(const FileSignature& other) const { return !(*this == other); }
+};
+
+FileSignature file_signature(const std::string& path) {
+    FileSignature signature;
+#ifdef _WIN32
+    WIN32_FILE_ATTRIBUTE_DATA data;
+    if (GetFileAttributesExA(path.c_str(), GetFileExInfoStandard, &data)) {
+        signature.exists = true;
+        signature.size = (static_cast<unsigned long long>(data.nFileSizeHigh) << 32) | data.nFileSizeLow;
+        signature.mtime = (static_cast<unsigned long long>(data.ftLastWriteTime.dwHighDateTime) << 32) |
+                          data.ftLastWriteTime.dwLowDateTime;
+    }
+#else
+    struct stat st;
+    if (stat(path.c_str(), &st) == 0) {
+        signature.exists = true;
+        signature.size = static_cast<unsigned long long>(st.st_size);
+        signature.mtime = static_cast<unsigned long long>(st.st_mtim.tv_sec) * 1000000000ULL + st.st_mtim.tv_nsec;
+    }
+#endif
+    return signature;
+}
+
+double elapsed_ms(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+HotReloadModel::HotReloadModel(const std::string& path, const ModelFactory& factory,
+                               const std::vector<std::vector<float>>& canary_images,
+                               const std::vector<std::vector<float>>& one_hot_canary_labels,
+                               float min_canary_accuracy, int poll_ms)
+    : path(path), factory(factory), canary_images(canary_images), one_hot_canary_labels(one_hot_canary_labels),
+      min_canary_accuracy(min_canary_accuracy), poll_ms(poll_ms) {
+    if (canary_images.empty()) {
+        throw std::invalid_argument("Hot reload needs a non-empty canary set");
+    }
+    std::shared_ptr<ModelVersion> initial = load_version(1);
+    if (initial->canary_accuracy < min_canary_accuracy) {
+        throw std::runtime_error("Model " + path + " scores " + std::to_string(initial->canary_accuracy) +
+                                 "% on the canary set, below the " + std::to_string(min_canary_accuracy) + "% minimum");
+    }
+    std::atomic_store(&current, initial);
+    watcher = std::thread(&HotReloadModel::watch, this);
+}
+
+HotReloadModel::~HotReloadModel() {
+    {
+        std::lock_guard<std::mutex> lock(stop_mutex);
+        stopping = true;
+    }
+    stop_cv.notify_all();
+    watcher.join();
+}
+
+std::shared_ptr<ModelVersion> HotReloadModel::load_version(int id) const {
+    std::shared_ptr<ModelVersion> version = std::make_shared<ModelVersion>();
+    version->id = id;
+    factory(version->model);
+    version->model.load(path);
+    version->model.pack();
+
+    std::vector<size_t> indices(canary_images.size());
+    std::iota(indices.begin(), indices.end(), 0);
+    int correct = count_correct(version->model, canary_images, one_hot_canary_labels, indices, 256);
+    version->canary_accuracy = 100.0f * correct / canary_images.size();
+    return version;
+}
+
+std::vector<std::vector<float>> HotReloadModel::forward(const std::vector<std::vector<float>>& inputs) {
+    // Pin the version for the whole batch; a concurrent swap only affects later calls
+    std::shared_ptr<ModelVersion> pinned = std::atomic_load(&current);
+    std::lock_guard<std::mutex> lock(pinned->mutex);
+    return pinned->model.forward(inputs);
+}
+
+ReloadStats HotReloadModel::stats() const {
+    std::lock_guard<std::mutex> lock(stats_mutex);
+    return reload_stats;
+}
+
+void HotReloadModel::watch() {
+    FileSignature loaded = file_signature(path);     // Version currently served (or last rejected)
+    FileSignature previous = loaded;
+    int next_id = 2;
+
+    std::unique_lock<std::mutex> stop_lock(stop_mutex);
+    while (!stop_cv.wait_for(stop_lock, std::chrono::milliseconds(poll_ms), [this] { return stopping; })) {
+        // Free retired versions once no batch holds them any more
+        for (size_t i = 0; i < retired.size();) {
+            if (retired[i].use_count() == 1) {
+                retired.erase(retired.begin() + i);
+            } else {
+                ++i;
+            }
+        }
+
+        // Reload only once the file has changed and then stayed unchanged for a full poll interval,
+        // so a model that is still being written is not picked up half way
+        FileSignature signature = file_signature(path);
+        bool settled = signature == previous;
+        previous = signature;
+        if (!signature.exists || signature == loaded || !settled) {
+            continue;
+        }
+        loaded = signature;
+
+        stop_lock.unlock();
+        auto start = std::chrono::steady_clock::now();
+        std::shared_ptr<ModelVersion> version;
+        std::string reason;
+        try {
+            version = load_version(next_id);
+            if (version->canary_accuracy < min_canary_accuracy) {
+                reason = "canary accuracy " + std::to_string(version->canary_accuracy) + "%";
+                version.reset();
+            }
+        } catch (const std::exception& e) {
+            reason = e.what();
+        }
+        double load_ms = elapsed_ms(start);
+
+        if (version) {
+            auto swap_start = std::chrono::steady_clock::now();
+            std::shared_ptr<ModelVersion> old = std::atomic_exchange(&current, version);
+            double swap_us = 1000.0 * elapsed_ms(swap_start);
+            retired.push_back(old);
+            ++next_id;
+            {
+                std::lock_guard<std::mutex> lock(stats_mutex);
+                ++reload_stats.reloads;
+                reload_stats.max_load_ms = std::max(reload_stats.max_load_ms, load_ms);
+                reload_stats.max_swap_us = std::max(reload_stats.max_swap_us, swap_us);
+            }
+            std::cout << "Reloaded " << path << " as version " << version->id << " (canary accuracy "
+                      << version->canary_accuracy << "%, load " << load_ms << " ms, swap " << swap_us << " us)" << std::endl;
+        } else {
+            {
+                std::lock_guard<std::mutex> lock(stats_mutex);
+                ++reload_stats.rejected;
+            }
+            std::cout << "Rejected new " << path << ": " << reason << "; still serving the previous version" << std::endl;
+        }
+        stop_lock.lock();
+    }
+}
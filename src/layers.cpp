@@ -1,9 +1,11 @@
 #include "../include/layers.hpp"
+#include "../include/simd_math.hpp"
 #include <cmath>
 #include <random>
 #include <stdexcept>
 #include <iostream>
 #include <algorithm>
+#include <numeric>
 #include <omp.h>
 
 // DenseLayer constructor
@@ -22,17 +24,124 @@ DenseLayer::DenseLayer(int input_size, int output_size) {
     }
 }
 
+DenseTiling DenseLayer::tiling;
+
+void DenseLayer::set_tiling(const DenseTiling& config) {
+    tiling = config;
+}
+
+const size_t DenseLayer::PANEL_WIDTH;
+
+// Packed inference kernel
+namespace {
+
+// Samples computed together per panel, so each weight load feeds several accumulators.
+// A register block sized for the ISA rather than the cache, so DenseTiling does not apply here.
+const size_t PACKED_BATCH_TILE = 4;
+
+// ROWS samples times one panel: the accumulators stay in registers while the panel streams by
+template <size_t ROWS>
+void packed_panel(const std::vector<std::vector<float>>& inputs, size_t i0, const float* panel,
+                  const float* bias, size_t input_size, size_t width, std::vector<std::vector<float>>& outputs, size_t j0) {
+    const size_t P = DenseLayer::PANEL_WIDTH;
+    const float* x[ROWS];
+    float acc[ROWS][P];
+    for (size_t b = 0; b < ROWS; ++b) {
+        x[b] = inputs[i0 + b].data();
+        for (size_t jj = 0; jj < P; ++jj) {
+            acc[b][jj] = jj < width ? bias[jj] : 0.0f;
+        }
+    }
+
+    for (size_t k = 0; k < input_size; ++k) {
+        const float* w = panel + k * P;
+        for (size_t b = 0; b < ROWS; ++b) {
+            const float x_k = x[b][k];
+            #pragma omp simd
+            for (size_t jj = 0; jj < P; ++jj) {
+                acc[b][jj] += x_k * w[jj];
+            }
+        }
+    }
+
+    for (size_t b = 0; b < ROWS; ++b) {
+        std::copy(acc[b], acc[b] + width, outputs[i0 + b].data() + j0);
+    }
+}
+
+} // namespace
+
+// Repack the weights into contiguous, zero-padded output panels
+void DenseLayer::pack() {
+    const size_t input_size = weights.size();
+    const size_t output_size = biases.size();
+    const size_t num_panels = (output_size + PANEL_WIDTH - 1) / PANEL_WIDTH;
+    packed_weights.assign(num_panels * input_size * PANEL_WIDTH, 0.0f);
+
+    #pragma omp parallel for schedule(static)
+    for (size_t p = 0; p < num_panels; ++p) {
+        const size_t j0 = p * PANEL_WIDTH;
+        const size_t width = std::min(PANEL_WIDTH, output_size - j0);
+        float* panel = &packed_weights[p * input_size * PANEL_WIDTH];
+        for (size_t k = 0; k < input_size; ++k) {
+            std::copy(weights[k].begin() + j0, weights[k].begin() + j0 + width, panel + k * PANEL_WIDTH);
+        }
+    }
+}
+
 // DenseLayer forward pass
 std::vector<std::vector<float>> DenseLayer::forward(const std::vector<std::vector<float>>& inputs) {
     this->inputs = inputs; // Cache inputs for backpropagation
-    std::vector<std::vector<float>> outputs(inputs.size(), std::vector<float>(biases.size(), 0.0f));
+    const size_t batch_size = inputs.size();
+    const size_t input_size = weights.size();
+    const size_t output_size = biases.size();
+
+    if (!packed_weights.empty()) {
+        // Packed layout: one task per (batch tile, output panel), each streaming its panel once
+        const size_t num_panels = (output_size + PANEL_WIDTH - 1) / PANEL_WIDTH;
+        std::vector<std::vector<float>> outputs(batch_size, std::vector<float>(output_size));
+        #pragma omp parallel for collapse(2) schedule(static)
+        for (size_t i0 = 0; i0 < batch_size; i0 += PACKED_BATCH_TILE) {
+            for (size_t p = 0; p < num_panels; ++p) {
+                const size_t j0 = p * PANEL_WIDTH;
+                const size_t width = std::min(PANEL_WIDTH, output_size - j0);
+                const float* panel = &packed_weights[p * input_size * PANEL_WIDTH];
+                switch (std::min(PACKED_BATCH_TILE, batch_size - i0)) {
+                    case 4: packed_panel<4>(inputs, i0, panel, &biases[j0], input_size, width, outputs, j0); break;
+                    case 3: packed_panel<3>(inputs, i0, panel, &biases[j0], input_size, width, outputs, j0); break;
+                    case 2: packed_panel<2>(inputs, i0, panel, &biases[j0], input_size, width, outputs, j0); break;
+                    default: packed_panel<1>(inputs, i0, panel, &biases[j0], input_size, width, outputs, j0); break;
+                }
+            }
+        }
+        return outputs;
+    }
 
+    const size_t batch_tile = tiling.batch_tile;
+    const size_t input_tile = tiling.input_tile;
+    const size_t output_tile = tiling.output_tile;
+    std::vector<std::vector<float>> outputs(batch_size, biases);
+
+    // Output tiles are independent; within a tile, accumulate along contiguous weight rows
     #pragma omp parallel for collapse(2) schedule(static)
-    for (size_t i = 0; i < inputs.size(); ++i) {
-        for (size_t j = 0; j < biases.size(); ++j) {
-            outputs[i][j] = biases[j];
-            for (size_t k = 0; k < weights.size(); ++k) {
-                outputs[i][j] += inputs[i][k] * weights[k][j];
+    for (size_t i0 = 0; i0 < batch_size; i0 += batch_tile) {
+        for (size_t j0 = 0; j0 < output_size; j0 += output_tile) {
+            const size_t i1 = std::min(i0 + batch_tile, batch_size);
+            const size_t j1 = std::min(j0 + output_tile, output_size);
+            for (size_t k0 = 0; k0 < input_size; k0 += input_tile) {
+                const size_t k1 = std::min(k0 + input_tile, input_size);
+                for (size_t i = i0; i < i1; ++i) {
+                    float* out = outputs[i].data();
+                    const float* x = inputs[i].data();
+                    for (size_t k = k0; k < k1; ++k) {
+                        const float x_k = x[k];
+                        const float* w = weights[k].data();
+                        #pragma omp simd
+                        for (size_t j = j0; j < j1; ++j) {
+                            out[j] += x_k * w[j];
+                        }
+                    }
+                }
             }
         }
     }
@@ -42,38 +151,68 @@ std::vector<std::vector<float>> DenseLayer::forward(const std::vector<std::vecto
 
 // DenseLayer backward pass
 std::vector<std::vector<float>> DenseLayer::backward(const std::vector<std::vector<float>>& gradient) {
-    size_t batch_size = gradient.size();
-    size_t input_size = weights.size();
-    size_t output_size = weights[0].size();
+    const size_t batch_size = gradient.size();
+    const size_t input_size = weights.size();
+    const size_t output_size = weights[0].size();
+    const size_t batch_tile = tiling.batch_tile;
+    const size_t input_tile = tiling.input_tile;
+    const size_t output_tile = tiling.output_tile;
+    const float inv_batch = 1.0f / static_cast<float>(batch_size); // Average gradients over the batch
 
     // Gradients for weights, biases, and inputs
     weight_gradients.assign(input_size, std::vector<float>(output_size, 0.0f));
     bias_gradients.assign(output_size, 0.0f);
     std::vector<std::vector<float>> input_gradients(batch_size, std::vector<float>(input_size, 0.0f));
 
+    // Weight gradients: each thread owns a tile of weight_gradients, so accumulation is race-free
     #pragma omp parallel for collapse(2) schedule(static)
-    // Calculate weight and bias gradients
-    for (size_t i = 0; i < batch_size; ++i) {
-        for (size_t j = 0; j < output_size; ++j) {
-            bias_gradients[j] += gradient[i][j]; // Accumulate bias gradients
-            for (size_t k = 0; k < input_size; ++k) {
-                weight_gradients[k][j] += inputs[i][k] * gradient[i][j]; // Accumulate weight gradients
-                input_gradients[i][k] += gradient[i][j] * weights[k][j]; // Backpropagate to inputs
+    for (size_t k0 = 0; k0 < input_size; k0 += input_tile) {
+        for (size_t j0 = 0; j0 < output_size; j0 += output_tile) {
+            const size_t k1 = std::min(k0 + input_tile, input_size);
+            const size_t j1 = std::min(j0 + output_tile, output_size);
+            for (size_t i = 0; i < batch_size; ++i) {
+                const float* g = gradient[i].data();
+                for (size_t k = k0; k < k1; ++k) {
+                    const float x_k = inputs[i][k] * inv_batch;
+                    float* wg = weight_gradients[k].data();
+                    #pragma omp simd
+                    for (size_t j = j0; j < j1; ++j) {
+                        wg[j] += x_k * g[j];
+                    }
+                }
             }
         }
     }
 
+    // Bias gradients
     #pragma omp parallel for schedule(static)
-    // Average gradients over the batch
-    for (auto& row : weight_gradients) {
-        for (auto& val : row) {
-            val /= static_cast<float>(batch_size);
+    for (size_t j = 0; j < output_size; ++j) {
+        float sum = 0.0f;
+        for (size_t i = 0; i < batch_size; ++i) {
+            sum += gradient[i][j];
         }
+        bias_gradients[j] = sum * inv_batch;
     }
 
-    #pragma omp parallel for schedule(static)
-    for (auto& val : bias_gradients) {
-        val /= static_cast<float>(batch_size);
+    // Backpropagate to inputs: dot products along contiguous weight rows
+    #pragma omp parallel for collapse(2) schedule(static)
+    for (size_t i0 = 0; i0 < batch_size; i0 += batch_tile) {
+        for (size_t k0 = 0; k0 < input_size; k0 += input_tile) {
+            const size_t i1 = std::min(i0 + batch_tile, batch_size);
+            const size_t k1 = std::min(k0 + input_tile, input_size);
+            for (size_t i = i0; i < i1; ++i) {
+                const float* g = gradient[i].data();
+                for (size_t k = k0; k < k1; ++k) {
+                    const float* w = weights[k].data();
+                    float sum = 0.0f;
+                    #pragma omp simd reduction(+:sum)
+                    for (size_t j = 0; j < output_size; ++j) {
+                        sum += g[j] * w[j];
+                    }
+                    input_gradients[i][k] = sum;
+                }
+            }
+        }
     }
 
     return input_gradients; // Gradient to pass to the previous layer
@@ -82,69 +221,173 @@ std::vector<std::vector<float>> DenseLayer::backward(const std::vector<std::vect
 
 // DenseLayer update
 void DenseLayer::update(Optimizer& optimizer) {
+    std::vector<float>().swap(packed_weights); // Stale once the weights change; free it and pack() again for inference
     optimizer.update(weights, weight_gradients);
     optimizer.update(biases, bias_gradients);
-}
-
-// ActivationLayer implementation
-ActivationLayer::ActivationLayer(const std::string& type) : activation_type(type) {}
-
-std::vector<std::vector<float>> ActivationLayer::forward(const std::vector<std::vector<float>>& inputs) {
-    this->inputs = inputs; // Cache inputs for backpropagation
-    std::vector<std::vector<float>> outputs = inputs;
 
-    if (activation_type == "relu") {
-        // Parallelize ReLU activation using traditional for loops
+    // Keep pruned weights at zero
+    if (!weight_mask.empty()) {
         #pragma omp parallel for schedule(static)
-        for (size_t i = 0; i < outputs.size(); ++i) {
-            for (size_t j = 0; j < outputs[i].size(); ++j) {
-                outputs[i][j] = std::max(0.0f, outputs[i][j]); // ReLU: max(0, x)
+        for (size_t k = 0; k < weights.size(); ++k) {
+            for (size_t j = 0; j < weights[k].size(); ++j) {
+                if (!weight_mask[k][j]) {
+                    weights[k][j] = 0.0f;
+                }
             }
         }
     }
-    else if (activation_type == "softmax") {
-        // Parallelize Softmax activation per row
-        #pragma omp parallel for schedule(static)
-        for (size_t i = 0; i < outputs.size(); ++i) {
-            float max_val = *std::max_element(outputs[i].begin(), outputs[i].end());
-            float sum_exp = 0.0f;
-
-            // Compute sum of exponentials
-            for (size_t j = 0; j < outputs[i].size(); ++j) {
-                outputs[i][j] = std::exp(outputs[i][j] - max_val); // For numerical stability
-                sum_exp += outputs[i][j];
-            }
+}
 
-            // Normalize to get probabilities
-            for (size_t j = 0; j < outputs[i].size(); ++j) {
-                outputs[i][j] /= sum_exp; // Softmax formula
-            }
-        }
+// Activation kernels: element-wise over one row, vectorized with SimdMath
+namespace {
+
+const float LEAKY_RELU_SLOPE = 0.01f;
+const float INV_SQRT2 = 0.70710678118654752f;
+const float INV_SQRT_2PI = 0.39894228040143268f;
+
+typedef void (*ActivationForward)(const float* x, float* y, size_t n);
+typedef void (*ActivationBackward)(const float* x, const float* grad, float* dx, size_t n);
+
+struct ActivationKernels {
+    ActivationForward forward;
+    ActivationBackward backward;
+};
+
+void relu_forward(const float* x, float* y, size_t n) {
+    #pragma omp simd
+    for (size_t i = 0; i < n; ++i) {
+        const float v = x[i];
+        y[i] = v > 0.0f ? v : 0.0f; // ReLU: max(0, x)
     }
-    else {
-        throw std::invalid_argument("Unsupported activation type: " + activation_type);
+}
+
+void relu_backward(const float* x, const float* grad, float* dx, size_t n) {
+    #pragma omp simd
+    for (size_t i = 0; i < n; ++i) {
+        const float g = grad[i];
+        dx[i] = x[i] > 0.0f ? g : 0.0f;
     }
+}
 
-    return outputs;
+void leaky_relu_forward(const float* x, float* y, size_t n) {
+    #pragma omp simd
+    for (size_t i = 0; i < n; ++i) {
+        const float v = x[i];
+        y[i] = SimdMath::select(v > 0.0f, v, LEAKY_RELU_SLOPE * v);
+    }
 }
 
-std::vector<std::vector<float>> ActivationLayer::backward(const std::vector<std::vector<float>>& gradient) {
-    std::vector<std::vector<float>> input_gradients = gradient;
+void leaky_relu_backward(const float* x, const float* grad, float* dx, size_t n) {
+    #pragma omp simd
+    for (size_t i = 0; i < n; ++i) {
+        const float g = grad[i];
+        dx[i] = SimdMath::select(x[i] > 0.0f, g, LEAKY_RELU_SLOPE * g);
+    }
+}
 
-    if (activation_type == "relu") {
-        // Parallelize the ReLU backward pass using traditional for loops
-        #pragma omp parallel for schedule(static)
-        for (size_t i = 0; i < inputs.size(); ++i) {
-            for (size_t j = 0; j < inputs[i].size(); ++j) {
-                input_gradients[i][j] *= (inputs[i][j] > 0) ? 1.0f : 0.0f; // Gradient of ReLU
-            }
-        }
+void sigmoid_forward(const float* x, float* y, size_t n) {
+    #pragma omp simd
+    for (size_t i = 0; i < n; ++i) {
+        y[i] = 1.0f / (1.0f + SimdMath::exp(-x[i]));
+    }
+}
+
+void sigmoid_backward(const float* x, const float* grad, float* dx, size_t n) {
+    #pragma omp simd
+    for (size_t i = 0; i < n; ++i) {
+        float s = 1.0f / (1.0f + SimdMath::exp(-x[i]));
+        dx[i] = grad[i] * s * (1.0f - s);
     }
-    else if (activation_type == "softmax") {
-        // Do not modify gradients; already handled by CrossEntropyLoss
+}
+
+void tanh_forward(const float* x, float* y, size_t n) {
+    SimdMath::tanh(x, y, n);
+}
+
+void tanh_backward(const float* x, const float* grad, float* dx, size_t n) {
+    #pragma omp simd
+    for (size_t i = 0; i < n; ++i) {
+        float t = SimdMath::tanh(x[i]);
+        dx[i] = grad[i] * (1.0f - t * t);
+    }
+}
+
+// GELU: x * Phi(x), with the exact (erf-based) normal CDF
+void gelu_forward(const float* x, float* y, size_t n) {
+    #pragma omp simd
+    for (size_t i = 0; i < n; ++i) {
+        y[i] = 0.5f * x[i] * (1.0f + SimdMath::erf(x[i] * INV_SQRT2));
+    }
+}
+
+void gelu_backward(const float* x, const float* grad, float* dx, size_t n) {
+    #pragma omp simd
+    for (size_t i = 0; i < n; ++i) {
+        float cdf = 0.5f * (1.0f + SimdMath::erf(x[i] * INV_SQRT2));
+        float pdf = INV_SQRT_2PI * SimdMath::exp(-0.5f * x[i] * x[i]);
+        dx[i] = grad[i] * (cdf + x[i] * pdf);
+    }
+}
+
+void softmax_forward(const float* x, float* y, size_t n) {
+    SimdMath::softmax(x, y, n);
+}
+
+void softmax_backward(const float* x, const float* grad, float* dx, size_t n) {
+    // Do not modify gradients; already handled by CrossEntropyLoss
+    std::copy(grad, grad + n, dx);
+}
+
+// Indexed by Activation
+const ActivationKernels ACTIVATION_KERNELS[] = {
+    {relu_forward, relu_backward},
+    {leaky_relu_forward, leaky_relu_backward},
+    {sigmoid_forward, sigmoid_backward},
+    {tanh_forward, tanh_backward},
+    {gelu_forward, gelu_backward},
+    {softmax_forward, softmax_backward},
+};
+
+} // namespace
+
+Activation parse_activation(const std::string& name) {
+    if (name == "relu") return Activation::ReLU;
+    if (name == "leaky_relu") return Activation::LeakyReLU;
+    if (name == "sigmoid") return Activation::Sigmoid;
+    if (name == "tanh") return Activation::Tanh;
+    if (name == "gelu") return Activation::GELU;
+    if (name == "softmax") return Activation::Softmax;
+    throw std::invalid_argument("Unsupported activation type: " + name);
+}
+
+// ActivationLayer implementation
+ActivationLayer::ActivationLayer(Activation type) : activation(type) {}
+
+ActivationLayer::ActivationLayer(const std::string& type) : activation(parse_activation(type)) {}
+
+std::vector<std::vector<float>> ActivationLayer::forward(const std::vector<std::vector<float>>& inputs) {
+    this->inputs = inputs; // Cache inputs for backpropagation
+    std::vector<std::vector<float>> outputs(inputs.size());
+    const ActivationForward kernel = ACTIVATION_KERNELS[static_cast<int>(activation)].forward;
+
+    // Parallelize over rows; each row is one vectorized kernel call
+    #pragma omp parallel for schedule(static)
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        outputs[i].resize(inputs[i].size());
+        kernel(inputs[i].data(), outputs[i].data(), inputs[i].size());
     }
-    else {
-        throw std::invalid_argument("Unsupported activation type: " + activation_type);
+
+    return outputs;
+}
+
+std::vector<std::vector<float>> ActivationLayer::backward(const std::vector<std::vector<float>>& gradient) {
+    std::vector<std::vector<float>> input_gradients(gradient.size());
+    const ActivationBackward kernel = ACTIVATION_KERNELS[static_cast<int>(activation)].backward;
+
+    #pragma omp parallel for schedule(static)
+    for (size_t i = 0; i < gradient.size(); ++i) {
+        input_gradients[i].resize(gradient[i].size());
+        kernel(inputs[i].data(), gradient[i].data(), input_gradients[i].data(), gradient[i].size());
     }
 
     return input_gradients;
@@ -175,6 +418,14 @@ void DenseLayer::load(std::istream& is) {
     size_t output_size = 0;
     is.read(reinterpret_cast<char*>(&input_size), sizeof(input_size));
     is.read(reinterpret_cast<char*>(&output_size), sizeof(output_size));
+    if (!is) {
+        throw std::runtime_error("Model data is truncated");
+    }
+    if (!weights.empty() && (input_size != weights.size() || output_size != weights[0].size())) {
+        throw std::runtime_error("Saved DenseLayer shape " + std::to_string(input_size) + "x" + std::to_string(output_size) +
+                                 " does not match the layer (" + std::to_string(weights.size()) + "x" +
+                                 std::to_string(weights[0].size()) + ")");
+    }
 
     // Resize weights and biases accordingly
     weights.resize(input_size, std::vector<float>(output_size));
@@ -187,4 +438,189 @@ void DenseLayer::load(std::istream& is) {
 
     // Load biases
     is.read(reinterpret_cast<char*>(biases.data()), biases.size() * sizeof(float));
+
+    // A freshly loaded model is unmasked; pruning again recovers zeroed blocks first
+    weight_mask.clear();
+}
+
+// DenseLayer magnitude pruning
+void DenseLayer::prune(float target_sparsity) {
+    std::vector<float>().swap(packed_weights);
+    const size_t block = SparseDenseLayer::BLOCK_SIZE;
+    size_t input_size = weights.size();
+    size_t output_size = weights[0].size();
+    size_t blocks_per_row = (output_size + block - 1) / block;
+    size_t num_blocks = input_size * blocks_per_row;
+
+    // Score each 1 x BLOCK_SIZE block by its L1 norm so the result maps onto SparseDenseLayer
+    std::vector<float> scores(num_blocks, 0.0f);
+    #pragma omp parallel for schedule(static)
+    for (size_t k = 0; k < input_size; ++k) {
+        for (size_t j = 0; j < output_size; ++j) {
+            scores[k * blocks_per_row + j / block] += std::fabs(weights[k][j]);
+        }
+    }
+
+    size_t num_pruned = static_cast<size_t>(std::max(0.0f, std::min(1.0f, target_sparsity)) * num_blocks);
+    std::vector<size_t> order(num_blocks);
+    std::iota(order.begin(), order.end(), 0);
+    std::nth_element(order.begin(), order.begin() + num_pruned, order.end(),
+                     [&scores](size_t a, size_t b) { return scores[a] < scores[b]; });
+
+    weight_mask.assign(input_size, std::vector<unsigned char>(output_size, 1));
+    for (size_t n = 0; n < num_pruned; ++n) {
+        size_t k = order[n] / blocks_per_row;
+        size_t j_begin = (order[n] % blocks_per_row) * block;
+        size_t j_end = std::min(j_begin + block, output_size);
+        for (size_t j = j_begin; j < j_end; ++j) {
+            weight_mask[k][j] = 0;
+            weights[k][j] = 0.0f;
+        }
+    }
+}
+
+// Fraction of zero weights
+float DenseLayer::sparsity() const {
+    size_t zeros = 0;
+    size_t total = 0;
+    for (const auto& row : weights) {
+        zeros += std::count(row.begin(), row.end(), 0.0f);
+        total += row.size();
+    }
+    return total == 0 ? 0.0f : static_cast<float>(zeros) / total;
+}
+
+const size_t SparseDenseLayer::BLOCK_SIZE;
+
+// SparseDenseLayer constructors
+SparseDenseLayer::SparseDenseLayer(int input_size, int output_size)
+    : input_size(input_size), output_size(output_size), row_ptr(input_size + 1, 0), biases(output_size, 0.0f) {}
+
+SparseDenseLayer::SparseDenseLayer(const DenseLayer& dense) {
+    const auto& dense_weights = dense.get_weights();
+    input_size = dense_weights.size();
+    output_size = dense_weights[0].size();
+    biases = dense.get_biases();
+
+    // Keep every block that has at least one non-zero weight
+    row_ptr.assign(1, 0);
+    for (size_t k = 0; k < input_size; ++k) {
+        for (size_t j_begin = 0; j_begin < output_size; j_begin += BLOCK_SIZE) {
+            size_t j_end = std::min(j_begin + BLOCK_SIZE, output_size);
+            bool non_zero = false;
+            for (size_t j = j_begin; j < j_end; ++j) {
+                non_zero = non_zero || dense_weights[k][j] != 0.0f;
+            }
+            if (!non_zero) {
+                continue;
+            }
+            block_cols.push_back(static_cast<uint32_t>(j_begin));
+            for (size_t t = 0; t < BLOCK_SIZE; ++t) {
+                values.push_back(j_begin + t < output_size ? dense_weights[k][j_begin + t] : 0.0f);
+            }
+        }
+        row_ptr.push_back(static_cast<uint32_t>(block_cols.size()));
+    }
+}
+
+// SparseDenseLayer forward pass
+std::vector<std::vector<float>> SparseDenseLayer::forward(const std::vector<std::vector<float>>& inputs) {
+    // Accumulate into a row padded to a whole number of blocks, then trim
+    size_t padded_size = ((output_size + BLOCK_SIZE - 1) / BLOCK_SIZE) * BLOCK_SIZE;
+    std::vector<std::vector<float>> outputs(inputs.size());
+
+    #pragma omp parallel for schedule(static)
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        std::vector<float> row(padded_size, 0.0f);
+        std::copy(biases.begin(), biases.end(), row.begin());
+        float* out = row.data();
+
+        for (size_t k = 0; k < input_size; ++k) {
+            const float x = inputs[i][k];
+            if (x == 0.0f) {
+                continue; // ReLU activations are mostly zero
+            }
+            for (uint32_t b = row_ptr[k]; b < row_ptr[k + 1]; ++b) {
+                float* dst = out + block_cols[b];
+                const float* src = values.data() + static_cast<size_t>(b) * BLOCK_SIZE;
+                #pragma omp simd
+                for (size_t t = 0; t < BLOCK_SIZE; ++t) {
+                    dst[t] += x * src[t];
+                }
+            }
+        }
+
+        row.resize(output_size);
+        outputs[i] = std::move(row);
+    }
+
+    return outputs;
+}
+
+std::vector<std::vector<float>> SparseDenseLayer::backward(const std::vector<std::vector<float>>& gradient) {
+    throw std::logic_error("SparseDenseLayer is inference-only; fine-tune the pruned DenseLayer instead");
+}
+
+// SparseDenseLayer save implementation
+void SparseDenseLayer::save(std::ostream& os) const {
+    size_t num_blocks = block_cols.size();
+    os.write(reinterpret_cast<const char*>(&input_size), sizeof(input_size));
+    os.write(reinterpret_cast<const char*>(&output_size), sizeof(output_size));
+    os.write(reinterpret_cast<const char*>(&num_blocks), sizeof(num_blocks));
+
+    os.write(reinterpret_cast<const char*>(row_ptr.data()), row_ptr.size() * sizeof(uint32_t));
+    os.write(reinterpret_cast<const char*>(block_cols.data()), block_cols.size() * sizeof(uint32_t));
+    os.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(float));
+    os.write(reinterpret_cast<const char*>(biases.data()), biases.size() * sizeof(float));
+}
+
+// SparseDenseLayer load implementation
+void SparseDenseLayer::load(std::istream& is) {
+    size_t saved_input_size = 0;
+    size_t saved_output_size = 0;
+    size_t num_blocks = 0;
+    is.read(reinterpret_cast<char*>(&saved_input_size), sizeof(saved_input_size));
+    is.read(reinterpret_cast<char*>(&saved_output_size), sizeof(saved_output_size));
+    is.read(reinterpret_cast<char*>(&num_blocks), sizeof(num_blocks));
+    if (!is) {
+        throw std::runtime_error("Model data is truncated");
+    }
+    if (saved_input_size != input_size || saved_output_size != output_size) {
+        throw std::runtime_error("Saved SparseDenseLayer shape " + std::to_string(saved_input_size) + "x" +
+                                 std::to_string(saved_output_size) + " does not match the layer (" +
+                                 std::to_string(input_size) + "x" + std::to_string(output_size) + ")");
+    }
+    const size_t blocks_per_row = (output_size + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    if (num_blocks > input_size * blocks_per_row) {
+        throw std::runtime_error("SparseDenseLayer has more blocks than its shape allows");
+    }
+
+    row_ptr.resize(input_size + 1);
+    block_cols.resize(num_blocks);
+    values.resize(num_blocks * BLOCK_SIZE);
+    biases.resize(output_size);
+
+    is.read(reinterpret_cast<char*>(row_ptr.data()), row_ptr.size() * sizeof(uint32_t));
+    is.read(reinterpret_cast<char*>(block_cols.data()), block_cols.size() * sizeof(uint32_t));
+    is.read(reinterpret_cast<char*>(values.data()), values.size() * sizeof(float));
+    is.read(reinterpret_cast<char*>(biases.data()), biases.size() * sizeof(float));
+    if (!is) {
+        throw std::runtime_error("Model data is truncated");
+    }
+
+    // The forward pass indexes with these directly, so a corrupt file must not get past here
+    if (row_ptr[0] != 0 || row_ptr[input_size] != num_blocks) {
+        throw std::runtime_error("SparseDenseLayer row pointers do not cover its blocks");
+    }
+    for (size_t k = 0; k < input_size; ++k) {
+        if (row_ptr[k] > row_ptr[k + 1]) {
+            throw std::runtime_error("SparseDenseLayer row pointers are not monotonic");
+        }
+    }
+    const size_t padded_size = blocks_per_row * BLOCK_SIZE;
+    for (uint32_t col : block_cols) {
+        if (static_cast<size_t>(col) + BLOCK_SIZE > padded_size) {
+            throw std::runtime_error("SparseDenseLayer block column out of range");
+        }
+    }
 }
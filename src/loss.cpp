@@ -1,13 +1,17 @@
 #include "../include/loss.hpp"
+#include "../include/simd_math.hpp"
 
 float CrossEntropyLoss::calculate_loss(const std::vector<std::vector<float>>& predictions,
                                       const std::vector<std::vector<float>>& targets) {
     float total_loss = 0.0f;
 
     for (size_t i = 0; i < predictions.size(); ++i) {
+        const float* prediction = predictions[i].data();
+        const float* target = targets[i].data();
+        #pragma omp simd reduction(+:total_loss)
         for (size_t j = 0; j < predictions[i].size(); ++j) {
             // Cross-Entropy: -sum(target * log(prediction))
-            total_loss += targets[i][j] * std::log(predictions[i][j] + 1e-9f); // Add epsilon to avoid log(0)
+            total_loss += target[j] * SimdMath::log(prediction[j] + 1e-9f); // Add epsilon to avoid log(0)
         }
     }
 
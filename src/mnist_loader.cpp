@@ -95,3 +95,78 @@ std::vector<std::vector<float>> one_hot_encode(const std::vector<int>& labels, i
     }
     return encoded;
 }
+
+namespace {
+
+const uint32_t IDX3_UBYTE_MAGIC = 2051;
+
+uint32_t read_big_endian(std::istream& input) {
+    unsigned char bytes[4];
+    if (!input.read((char*)bytes, sizeof(bytes))) {
+        throw std::runtime_error("Truncated stream header");
+    }
+    return ((uint32_t)bytes[0] << 24) | ((uint32_t)bytes[1] << 16) | ((uint32_t)bytes[2] << 8) | bytes[3];
+}
+
+void write_big_endian(std::ostream& output, uint32_t value) {
+    unsigned char bytes[4] = {(unsigned char)(value >> 24), (unsigned char)(value >> 16),
+                              (unsigned char)(value >> 8), (unsigned char)value};
+    output.write((const char*)bytes, sizeof(bytes));
+}
+
+} // namespace
+
+MnistStreamReader::MnistStreamReader(std::istream& input) : input(input) {
+    if (read_big_endian(input) != IDX3_UBYTE_MAGIC) {
+        throw std::runtime_error("Stream does not start with an IDX3 image header");
+    }
+    remaining = read_big_endian(input);
+    bounded = remaining > 0;
+    uint32_t rows = read_big_endian(input);
+    uint32_t cols = read_big_endian(input);
+    pixels_per_image = static_cast<size_t>(rows) * cols;
+    if (pixels_per_image == 0) {
+        throw std::runtime_error("Stream header has empty images");
+    }
+}
+
+bool MnistStreamReader::next(std::vector<unsigned char>& image, int& label) {
+    if (bounded && remaining == 0) {
+        return false;
+    }
+
+    // A clean end of stream can only fall between records
+    int label_byte = input.get();
+    if (label_byte == std::char_traits<char>::eof()) {
+        if (bounded) {
+            throw std::runtime_error("Stream ended before the record count in its header");
+        }
+        return false;
+    }
+
+    image.resize(pixels_per_image);
+    if (!input.read((char*)image.data(), image.size())) {
+        throw std::runtime_error("Stream ended in the middle of a record");
+    }
+    label = label_byte;
+    if (bounded) {
+        --remaining;
+    }
+    return true;
+}
+
+void write_mnist_stream_header(std::ostream& output, uint32_t count, uint32_t rows, uint32_t cols) {
+    write_big_endian(output, IDX3_UBYTE_MAGIC);
+    write_big_endian(output, count);
+    write_big_endian(output, rows);
+    write_big_endian(output, cols);
+}
+
+void write_mnist_record(std::ostream& output, const std::vector<float>& image, int label) {
+    std::vector<char> record(image.size() + 1);
+    record[0] = static_cast<char>(label);
+    for (size_t i = 0; i < image.size(); ++i) {
+        record[i + 1] = static_cast<char>(static_cast<unsigned char>(image[i]));
+    }
+    output.write(record.data(), record.size());
+}
@@ -38,15 +38,61 @@ void NeuralNetwork::update(Optimizer& optimizer) {
     }
 }
 
+// Prune DenseLayers to their target sparsities
+void NeuralNetwork::prune(const std::vector<float>& target_sparsities) {
+    size_t dense_index = 0;
+    for (Layer* layer : layers) {
+        DenseLayer* dense = dynamic_cast<DenseLayer*>(layer);
+        if (dense == nullptr) {
+            continue;
+        }
+        if (dense_index >= target_sparsities.size()) {
+            throw std::invalid_argument("Missing target sparsity for DenseLayer " + std::to_string(dense_index));
+        }
+        dense->prune(target_sparsities[dense_index++]);
+    }
+}
+
+// Report DenseLayer sparsities
+std::vector<float> NeuralNetwork::sparsities() const {
+    std::vector<float> result;
+    for (const Layer* layer : layers) {
+        const DenseLayer* dense = dynamic_cast<const DenseLayer*>(layer);
+        if (dense != nullptr) {
+            result.push_back(dense->sparsity());
+        }
+    }
+    return result;
+}
+
+// Convert DenseLayers to SparseDenseLayers for inference
+void NeuralNetwork::sparsify() {
+    for (Layer*& layer : layers) {
+        DenseLayer* dense = dynamic_cast<DenseLayer*>(layer);
+        if (dense != nullptr) {
+            layer = new SparseDenseLayer(*dense);
+            delete dense;
+        }
+    }
+}
+
+// Repack DenseLayer weights for inference
+void NeuralNetwork::pack() {
+    for (Layer* layer : layers) {
+        DenseLayer* dense = dynamic_cast<DenseLayer*>(layer);
+        if (dense != nullptr) {
+            dense->pack();
+        }
+    }
+}
+
 // Save model to a file
 void NeuralNetwork::save(const std::string& filepath) const {
     std::ofstream file(filepath, std::ios::binary);
     if (!file.is_open()) {
         throw std::runtime_error("Failed to open file for saving: " + filepath);
     }
-    for (const Layer* layer : layers) {
-        layer->save(file);
-    }
+    save(file);
     file.close();
 }
 
@@ -56,8 +102,26 @@ void NeuralNetwork::load(const std::string& filepath) {
     if (!file.is_open()) {
         throw std::runtime_error("Failed to open file for loading: " + filepath);
     }
-    for (Layer* layer : layers) {
-        layer->load(file);
+    load(file);
+    if (file.peek() != std::ifstream::traits_type::eof()) {
+        throw std::runtime_error("Unexpected data after the model in " + filepath);
     }
     file.close();
 }
+
+// Save all layers to a stream
+void NeuralNetwork::save(std::ostream& os) const {
+    for (const Layer* layer : layers) {
+        layer->save(os);
+    }
+}
+
+// Load all layers from a stream
+void NeuralNetwork::load(std::istream& is) {
+    for (Layer* layer : layers) {
+        layer->load(is);
+    }
+    if (!is) {
+        throw std::runtime_error("Model data is truncated");
+    }
+}
@@ -0,0 +1,126 @@
+#include "../include/online.hpp"
+#include "../include/trainer.hpp"
+#include <chrono>
+#include <iostream>
+#include <numeric>
+#include <stdexcept>
+
+ReplayBuffer::ReplayBuffer(size_t capacity, size_t image_size)
+    : images(capacity * image_size), labels(capacity), image_size(image_size), capacity(capacity) {
+    if (capacity == 0) {
+        throw std::invalid_argument("Replay buffer capacity must be positive");
+    }
+}
+
+void ReplayBuffer::add(const std::vector<unsigned char>& image, int label) {
+    if (image.size() != image_size) {
+        throw std::invalid_argument("Record size does not match the replay buffer");
+    }
+    std::copy(image.begin(), image.end(), images.begin() + next * image_size);
+    labels[next] = static_cast<unsigned char>(label);
+    next = (next + 1) % capacity;
+    if (count < capacity) {
+        ++count;
+    }
+}
+
+void ReplayBuffer::sample(size_t batch_size, int num_classes, std::mt19937& rng,
+                          std::vector<std::vector<float>>& inputs, std::vector<std::vector<float>>& one_hot_labels) const {
+    std::uniform_int_distribution<size_t> pick(0, count - 1);
+    inputs.resize(batch_size);
+    one_hot_labels.resize(batch_size);
+    for (size_t n = 0; n < batch_size; ++n) {
+        size_t slot = pick(rng);
+        const unsigned char* pixels = &images[slot * image_size];
+        inputs[n].resize(image_size);
+        for (size_t j = 0; j < image_size; ++j) {
+            inputs[n][j] = pixels[j] / 255.0f;
+        }
+        one_hot_labels[n].assign(num_classes, 0.0f);
+        one_hot_labels[n][labels[slot]] = 1.0f;
+    }
+}
+
+OnlineStats train_online(NeuralNetwork& model, Optimizer& optimizer, MnistStreamReader& stream,
+                         const std::vector<std::vector<float>>& holdout_images,
+                         const std::vector<std::vector<float>>& one_hot_holdout_labels,
+                         const OnlineOptions& options, const EvaluationCallback& on_evaluation) {
+    if (options.batch_size <= 0 || options.update_every == 0) {
+        throw std::invalid_argument("Batch size and update interval must be positive");
+    }
+    if (options.buffer_size < static_cast<size_t>(options.batch_size)) {
+        throw std::invalid_argument("Replay buffer must hold at least one batch");
+    }
+    if (holdout_images.empty() || holdout_images[0].size() != stream.image_size()) {
+        throw std::invalid_argument("Held-out images do not match the stream's image size");
+    }
+    const int num_classes = static_cast<int>(one_hot_holdout_labels[0].size());
+    const size_t batch_size = static_cast<size_t>(options.batch_size);
+
+    ReplayBuffer buffer(options.buffer_size, stream.image_size());
+    std::mt19937 rng(std::random_device{}());
+    std::vector<size_t> holdout_indices(holdout_images.size());
+    std::iota(holdout_indices.begin(), holdout_indices.end(), 0);
+
+    // Reused for every record and minibatch, so nothing is allocated per update once warmed up
+    std::vector<unsigned char> image;
+    int label = 0;
+    std::vector<std::vector<float>> batch_inputs;
+    std::vector<std::vector<float>> batch_labels;
+    std::vector<size_t> batch_order(batch_size);
+    std::iota(batch_order.begin(), batch_order.end(), 0);
+
+    OnlineStats stats;
+    size_t since_update = 0;
+    float window_loss = 0.0f;           // Training metrics since the last evaluation
+    int window_correct = 0;
+    size_t window_updates = 0;
+    auto start = std::chrono::steady_clock::now();
+
+    auto evaluate = [&]() {
+        int correct = count_correct(model, holdout_images, one_hot_holdout_labels, holdout_indices, options.batch_size);
+        stats.holdout_accuracy = 100.0f * correct / holdout_images.size();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "Records " << stats.records << ", updates " << stats.updates;
+        if (window_updates > 0) {
+            size_t samples = window_updates * batch_size;
+            std::cout << " - Loss: " << window_loss / samples
+                      << ", Train Accuracy: " << 100.0f * window_correct / samples << "%";
+        }
+        std::cout << ", Held-out Accuracy: " << stats.holdout_accuracy << "% ("
+                  << stats.records / seconds << " records/s)" << std::endl;
+        window_loss = 0.0f;
+        window_correct = 0;
+        window_updates = 0;
+        if (on_evaluation) {
+            on_evaluation(stats);
+        }
+    };
+
+    while (stream.next(image, label)) {
+        if (label < 0 || label >= num_classes) {
+            throw std::runtime_error("Record " + std::to_string(stats.records) + " has invalid label " + std::to_string(label));
+        }
+        buffer.add(image, label);
+        ++stats.records;
+
+        // Replay one minibatch per update_every new records, once the buffer holds a full batch
+        if (++since_update >= options.update_every && buffer.size() >= batch_size) {
+            since_update = 0;
+            buffer.sample(batch_size, num_classes, rng, batch_inputs, batch_labels);
+            train_epoch(model, optimizer, batch_inputs, batch_labels, batch_order, options.batch_size, 0,
+                        window_loss, window_correct);
+            ++stats.updates;
+            ++window_updates;
+        }
+
+        if (options.eval_every > 0 && stats.records % options.eval_every == 0) {
+            evaluate();
+        }
+    }
+
+    if (options.eval_every == 0 || stats.records % options.eval_every != 0) {
+        evaluate();
+    }
+    return stats;
+}
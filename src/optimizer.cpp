@@ -21,4 +21,12 @@ void SGDOptimizer::update(std::vector<float>& biases, const std::vector<float>&
         if (grad < -1.0f) grad = -1.0f;
         biases[i] -= learning_rate * grad;
     }
-}
\ No newline at end of file
+}
+
+void SGDOptimizer::save(std::ostream& os) const {
+    os.write(reinterpret_cast<const char*>(&learning_rate), sizeof(learning_rate));
+}
+
+void SGDOptimizer::load(std::istream& is) {
+    is.read(reinterpret_cast<char*>(&learning_rate), sizeof(learning_rate));
+}
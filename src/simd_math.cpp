@@ -0,0 +1,35 @@
+#include "../include/simd_math.hpp"
+#include <algorithm>
+
+void SimdMath::tanh(const float* x, float* y, size_t n) {
+    #pragma omp simd
+    for (size_t i = 0; i < n; ++i) {
+        y[i] = SimdMath::tanh(x[i]);
+    }
+}
+
+void SimdMath::softmax(const float* x, float* y, size_t n) {
+    if (n == 0) {
+        return;
+    }
+
+    float max_val = x[0];
+    #pragma omp simd reduction(max:max_val)
+    for (size_t i = 0; i < n; ++i) {
+        max_val = std::max(max_val, x[i]);
+    }
+
+    // Subtract the max for numerical stability
+    float sum_exp = 0.0f;
+    #pragma omp simd reduction(+:sum_exp)
+    for (size_t i = 0; i < n; ++i) {
+        y[i] = SimdMath::exp(x[i] - max_val);
+        sum_exp += y[i];
+    }
+
+    const float inv_sum = 1.0f / sum_exp;
+    #pragma omp simd
+    for (size_t i = 0; i < n; ++i) {
+        y[i] *= inv_sum;
+    }
+}
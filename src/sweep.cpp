@@ -0,0 +1,317 @@
+#include "../include/sweep.hpp"
+#include "../include/neural_network.hpp"
+#include "../include/optimizer.hpp"
+#include "../include/trainer.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <exception>
+#include <condition_variable>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <omp.h>
+
+namespace {
+
+// Parse a comma-separated list of layer widths
+std::vector<int> parse_layers(const std::string& value) {
+    std::vector<int> layers;
+    std::istringstream is(value);
+    std::string width;
+    while (std::getline(is, width, ',')) {
+        layers.push_back(std::stoi(width));
+    }
+    return layers;
+}
+
+} // namespace
+
+SweepConfig load_sweep_config(const std::string& path) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        throw std::runtime_error("Unable to open file: " + path);
+    }
+
+    SweepConfig config;
+    std::string line;
+    int line_number = 0;
+    while (std::getline(file, line)) {
+        ++line_number;
+        std::istringstream is(line);
+        std::string key;
+        if (!(is >> key) || key[0] == '#') {
+            continue;
+        }
+
+        const std::string where = path + ":" + std::to_string(line_number);
+        if (key == "parallel") {
+            is >> config.parallel;
+        } else if (key == "keep_fraction") {
+            is >> config.keep_fraction;
+        } else if (key == "grace_epochs") {
+            is >> config.grace_epochs;
+        } else if (key == "validation_size") {
+            is >> config.validation_size;
+        } else if (key == "run") {
+            SweepRun run;
+            run.name = "run" + std::to_string(config.runs.size() + 1);
+            std::string option;
+            while (is >> option) {
+                size_t eq = option.find('=');
+                if (eq == std::string::npos) {
+                    throw std::runtime_error("Expected key=value, got '" + option + "' at " + where);
+                }
+                std::string name = option.substr(0, eq);
+                std::string value = option.substr(eq + 1);
+                if (name == "name") {
+                    run.name = value;
+                } else if (name == "layers") {
+                    run.hidden_layers = parse_layers(value);
+                } else if (name == "activation") {
+                    parse_activation(value); // Validate before any training starts
+                    run.activation = value;
+                } else if (name == "lr") {
+                    run.learning_rate = std::stof(value);
+                } else if (name == "batch") {
+                    run.batch_size = std::stoi(value);
+                } else if (name == "epochs") {
+                    run.epochs = std::stoi(value);
+                } else {
+                    throw std::runtime_error("Unknown run option '" + name + "' at " + where);
+                }
+            }
+            if (run.batch_size <= 0 || run.epochs <= 0) {
+                throw std::runtime_error("Batch size and epochs must be positive at " + where);
+            }
+            config.runs.push_back(run);
+        } else {
+            throw std::runtime_error("Unknown setting '" + key + "' at " + where);
+        }
+        if (key != "run" && is.fail()) {
+            throw std::runtime_error("Invalid value for '" + key + "' at " + where);
+        }
+    }
+
+    if (config.runs.empty()) {
+        throw std::runtime_error("No runs defined in sweep config: " + path);
+    }
+    return config;
+}
+
+namespace {
+
+// Training state of one run; models stay resident so runs can be time-sliced by epoch
+struct RunState {
+    const SweepRun* run;
+    NeuralNetwork model;
+    SGDOptimizer optimizer;
+    std::mt19937 rng;
+    bool active = false;
+    bool finished = false;
+    SweepResult result;
+
+    explicit RunState(const SweepRun& run)
+        : run(&run), optimizer(run.learning_rate), rng(std::random_device{}()) {}
+};
+
+void build_sweep_model(NeuralNetwork& model, const SweepRun& run, size_t input_size, size_t num_classes,
+                       size_t& parameter_bytes) {
+    int previous = static_cast<int>(input_size);
+    parameter_bytes = 0;
+    for (int width : run.hidden_layers) {
+        model.add_layer(new DenseLayer(previous, width));
+        model.add_layer(new ActivationLayer(run.activation));
+        parameter_bytes += (static_cast<size_t>(previous) * width + width) * sizeof(float);
+        previous = width;
+    }
+    model.add_layer(new DenseLayer(previous, static_cast<int>(num_classes)));
+    model.add_layer(new ActivationLayer(Activation::Softmax));
+    parameter_bytes += (static_cast<size_t>(previous) * num_classes + num_classes) * sizeof(float);
+}
+
+} // namespace
+
+std::vector<SweepResult> run_sweep(const SweepConfig& config,
+                                   const std::vector<std::vector<float>>& train_images,
+                                   const std::vector<std::vector<float>>& one_hot_train_labels,
+                                   const std::vector<std::vector<float>>& test_images,
+                                   const std::vector<std::vector<float>>& one_hot_test_labels) {
+    if (config.validation_size >= train_images.size()) {
+        throw std::invalid_argument("validation_size must be smaller than the training set");
+    }
+    const size_t num_train = train_images.size() - config.validation_size;
+
+    // Held-out tail of the training set ranks runs; the test set is only used for the final report
+    std::vector<size_t> validation_indices(config.validation_size);
+    for (size_t i = 0; i < validation_indices.size(); ++i) {
+        validation_indices[i] = num_train + i;
+    }
+    std::vector<size_t> test_indices(test_images.size());
+    for (size_t i = 0; i < test_indices.size(); ++i) {
+        test_indices[i] = i;
+    }
+
+    std::vector<std::unique_ptr<RunState>> states;
+    for (const SweepRun& run : config.runs) {
+        std::unique_ptr<RunState> state(new RunState(run));
+        state->result.name = run.name;
+        build_sweep_model(state->model, run, train_images[0].size(), one_hot_train_labels[0].size(),
+                          state->result.parameter_bytes);
+        states.push_back(std::move(state));
+    }
+
+    // Split the OpenMP threads (OMP_NUM_THREADS or the tuned count) evenly between the runs in flight
+    const int threads = omp_get_max_threads();
+    const int runs = static_cast<int>(states.size());
+    const int parallel = std::max(1, std::min(config.parallel > 0 ? config.parallel : threads, runs));
+    const int threads_per_run = std::max(1, threads / parallel);
+    std::cout << "Sweeping " << runs << " runs, " << parallel << " at a time with "
+              << threads_per_run << " threads each" << std::endl;
+
+    // rung_scores[e]: validation accuracies of the runs that have completed e + 1 epochs
+    struct RungScore {
+        float validation_accuracy;
+        RunState* state;
+    };
+    std::vector<std::vector<RungScore>> rung_scores;
+    std::mutex mutex;
+    std::condition_variable cv;
+
+    std::exception_ptr error;
+
+    // Early termination: stop every run ranked outside the top keep_fraction at this epoch. Runs that
+    // passed the epoch earlier are re-ranked too, so arriving first does not exempt a losing run.
+    // Called with the mutex held.
+    auto rerank = [&](size_t epoch, const RunState* current) {
+        const std::vector<RungScore>& scores = rung_scores[epoch];
+        if (static_cast<int>(epoch) + 1 < config.grace_epochs || scores.size() < 2) {
+            return;
+        }
+        size_t keep = std::max<size_t>(1, static_cast<size_t>(std::ceil(config.keep_fraction * scores.size())));
+        for (const RungScore& entry : scores) {
+            RunState* state = entry.state;
+            if (state->finished || state->result.stopped_early || state->result.epochs_trained >= state->run->epochs) {
+                continue;
+            }
+            size_t better = std::count_if(scores.begin(), scores.end(),
+                                          [&entry](const RungScore& s) { return s.validation_accuracy > entry.validation_accuracy; });
+            if (better >= keep) {
+                state->result.stopped_early = true;
+                if (state != current) {
+                    std::cout << "[" << state->result.name << "] Stopped: ranked outside the top "
+                              << config.keep_fraction * 100.0f << "% at epoch " << (epoch + 1) << std::endl;
+                }
+            }
+        }
+    };
+
+    auto worker = [&]() {
+        omp_set_num_threads(threads_per_run); // Per-thread setting: parallel regions of this run use threads_per_run
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            // Fair scheduling: advance the idle run with the fewest trained epochs
+            RunState* next = nullptr;
+            bool any_active = false;
+            for (auto& state : states) {
+                if (state->finished) {
+                    continue;
+                }
+                if (state->active) {
+                    any_active = true;
+                } else if (next == nullptr || state->result.epochs_trained < next->result.epochs_trained) {
+                    next = state.get();
+                }
+            }
+            if (next == nullptr) {
+                if (!any_active) {
+                    return;
+                }
+                cv.wait(lock);
+                continue;
+            }
+            next->active = true;
+            SweepResult& result = next->result;
+
+            // A run stopped by a later ranking while it waited only needs its final test score
+            if (!result.stopped_early) {
+                lock.unlock();
+
+                // Train one epoch and score it on the validation split
+                auto start = std::chrono::steady_clock::now();
+                float epoch_loss = 0.0f;
+                int correct = 0;
+                int validation_correct = 0;
+                try {
+                    train_epoch(next->model, next->optimizer, train_images, one_hot_train_labels,
+                                shuffled_order(num_train, next->rng), next->run->batch_size, 0, epoch_loss, correct);
+                    validation_correct = count_correct(next->model, train_images, one_hot_train_labels,
+                                                       validation_indices, next->run->batch_size);
+                } catch (...) {
+                    // Abandon this run; the error is rethrown once all workers have stopped
+                    lock.lock();
+                    error = std::current_exception();
+                    next->active = false;
+                    next->finished = true;
+                    cv.notify_all();
+                    continue;
+                }
+                float validation_accuracy = 100.0f * validation_correct / validation_indices.size();
+                double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+                lock.lock();
+                result.seconds += seconds;
+                result.validation_accuracy = validation_accuracy;
+                size_t epoch = static_cast<size_t>(result.epochs_trained++);
+                if (rung_scores.size() <= epoch) {
+                    rung_scores.resize(epoch + 1);
+                }
+                rung_scores[epoch].push_back(RungScore{validation_accuracy, next});
+                rerank(epoch, next);
+
+                std::cout << "[" << result.name << "] Epoch " << result.epochs_trained << "/" << next->run->epochs
+                          << " - Loss: " << epoch_loss / num_train << ", Validation Accuracy: " << validation_accuracy << "%"
+                          << (result.stopped_early ? " (stopped)" : "") << std::endl;
+            }
+
+            bool done = result.stopped_early || result.epochs_trained >= next->run->epochs;
+            if (done) {
+                // Keep the run marked active while it is scored on the test set
+                lock.unlock();
+                next->model.pack();
+                int test_correct = count_correct(next->model, test_images, one_hot_test_labels,
+                                                 test_indices, next->run->batch_size);
+                lock.lock();
+                result.test_accuracy = 100.0f * test_correct / test_indices.size();
+                next->finished = true;
+            }
+            next->active = false;
+            cv.notify_all();
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (int w = 0; w < parallel; ++w) {
+        workers.emplace_back(worker);
+    }
+    for (std::thread& t : workers) {
+        t.join();
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+
+    std::vector<SweepResult> results;
+    for (const auto& state : states) {
+        results.push_back(state->result);
+    }
+    std::sort(results.begin(), results.end(), [](const SweepResult& a, const SweepResult& b) {
+        return a.validation_accuracy > b.validation_accuracy;
+    });
+    return results;
+}
@@ -0,0 +1,74 @@
+#include "../include/trainer.hpp"
+#include "../include/loss.hpp"
+#include "../include/utils.hpp"
+#include <algorithm>
+#include <numeric>
+
+// Run one epoch of mini-batch training
+void train_epoch(NeuralNetwork& model, Optimizer& optimizer,
+                 const std::vector<std::vector<float>>& train_images,
+                 const std::vector<std::vector<float>>& one_hot_train_labels,
+                 const std::vector<size_t>& order, int batch_size, size_t start_batch,
+                 float& epoch_loss, int& correct, const BatchCallback& on_batch) {
+    CrossEntropyLoss loss_function;
+    size_t num_batches = (order.size() + batch_size - 1) / batch_size;
+
+    for (size_t batch = start_batch; batch < num_batches; ++batch) {
+        // Create mini-batch
+        size_t i = batch * batch_size;
+        size_t end = std::min(i + batch_size, order.size());
+        std::vector<std::vector<float>> batch_inputs;
+        std::vector<std::vector<float>> batch_labels;
+        for (size_t n = i; n < end; ++n) {
+            batch_inputs.push_back(train_images[order[n]]);
+            batch_labels.push_back(one_hot_train_labels[order[n]]);
+        }
+
+        // Forward pass
+        auto predictions = model.forward(batch_inputs);
+
+        // Calculate loss and accumulate
+        epoch_loss += loss_function.calculate_loss(predictions, batch_labels);
+
+        // Backward pass
+        auto gradients = loss_function.calculate_gradient(predictions, batch_labels);
+        model.backward(gradients);
+
+        // Update weights
+        model.update(optimizer);
+
+        // Calculate accuracy for the batch
+        correct += calculate_batch_accuracy(predictions, batch_labels);
+
+        if (on_batch) {
+            on_batch(batch + 1);
+        }
+    }
+}
+
+// Count correct predictions in batches
+int count_correct(NeuralNetwork& model,
+                  const std::vector<std::vector<float>>& images,
+                  const std::vector<std::vector<float>>& one_hot_labels,
+                  const std::vector<size_t>& indices, int batch_size) {
+    int correct = 0;
+    for (size_t i = 0; i < indices.size(); i += batch_size) {
+        size_t end = std::min(i + batch_size, indices.size());
+        std::vector<std::vector<float>> batch_inputs;
+        std::vector<std::vector<float>> batch_labels;
+        for (size_t n = i; n < end; ++n) {
+            batch_inputs.push_back(images[indices[n]]);
+            batch_labels.push_back(one_hot_labels[indices[n]]);
+        }
+        correct += calculate_batch_accuracy(model.forward(batch_inputs), batch_labels);
+    }
+    return correct;
+}
+
+// Random sample order for one epoch
+std::vector<size_t> shuffled_order(size_t size, std::mt19937& rng) {
+    std::vector<size_t> order(size);
+    std::iota(order.begin(), order.end(), 0);
+    std::shuffle(order.begin(), order.end(), rng);
+    return order;
+}
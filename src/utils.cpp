@@ -1,4 +1,5 @@
 #include "../include/utils.hpp"
+#include "../include/simd_math.hpp"
 #include <cmath>
 #include <numeric>
 #include <algorithm>
@@ -88,18 +89,6 @@ std::vector<float> Utils::normalize(const std::vector<float>& vec) {
 // Apply softmax to a vector
 std::vector<float> Utils::softmax(const std::vector<float>& vec) {
     std::vector<float> exp_vec(vec.size());
-    float sum_exp = 0.0f;
-
-    // Compute exponential values and their sum
-    for (size_t i = 0; i < vec.size(); ++i) {
-        exp_vec[i] = std::exp(vec[i]);
-        sum_exp += exp_vec[i];
-    }
-
-    // Normalize by dividing each exponential value by the sum
-    for (size_t i = 0; i < exp_vec.size(); ++i) {
-        exp_vec[i] /= sum_exp;
-    }
-
+    SimdMath::softmax(vec.data(), exp_vec.data(), vec.size());
     return exp_vec;
 }